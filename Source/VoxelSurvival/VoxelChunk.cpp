@@ -1,19 +1,32 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "VoxelChunk.h"
+#include "VoxelWorld.h"
+#include "VoxelRenderRegion.h"
+#include "VoxelWaterKernel.h"
+#include "VoxelCollisionComponent.h"
 #include "Engine/Engine.h"
+#include "Misc/App.h"
 
 AVoxelChunk::AVoxelChunk()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// Water is stepped by the owning world, so chunks never tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Create procedural mesh component
 	MeshComponent = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("VoxelMesh"));
 	RootComponent = MeshComponent;
 
-	// Enable collision
-	MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-	MeshComponent->SetCollisionObjectType(ECollisionChannel::ECC_WorldStatic);
+	// Render sections carry no collision, so uploading them never cooks anything
+	MeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	MeshComponent->SetCanEverAffectNavigation(false);
+
+	// Collision comes from greedily merged boxes on their own component, not the render mesh
+	CollisionComponent = CreateDefaultSubobject<UVoxelCollisionComponent>(TEXT("VoxelCollision"));
+	CollisionComponent->SetupAttachment(RootComponent);
+	CollisionComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	CollisionComponent->SetCollisionObjectType(ECollisionChannel::ECC_WorldStatic);
+	CollisionComponent->SetCollisionResponseToAllChannels(ECR_Block);
 	
 	// Enable replication for multiplayer
 	bReplicates = true;
@@ -25,44 +38,39 @@ void AVoxelChunk::BeginPlay()
 	Super::BeginPlay();
 }
 
-void AVoxelChunk::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-	// Update water physics
-	WaterUpdateTimer += DeltaTime;
-	if (WaterUpdateTimer >= WaterUpdateInterval)
-	{
-		WaterUpdateTimer = 0.0f;
-		UpdateWaterPhysics();
-	}
-}
-
 void AVoxelChunk::InitializeChunk(FIntVector Coordinate)
 {
 	ChunkCoordinate = Coordinate;
-	
-	// Initialize voxel data array
-	int32 TotalVoxels = ChunkSize * ChunkSize * ChunkSize;
-	VoxelData.SetNum(TotalVoxels);
-	
-	// Fill with air by default
-	for (int32 i = 0; i < TotalVoxels; i++)
-	{
-		VoxelData[i] = FVoxelData(EVoxelType::Air);
-	}
-}
+	ClearActiveWaterCells();
 
-int32 AVoxelChunk::GetVoxelIndex(int32 X, int32 Y, int32 Z) const
-{
-	return X + Y * ChunkSize + Z * ChunkSize * ChunkSize;
+	// Reactivate in case this actor is being reused from the chunk pool
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	
+	// Initialize voxel storage, filled with air by default
+	VoxelStorage.Init(FVoxelData(EVoxelType::Air));
 }
 
-bool AVoxelChunk::IsValidVoxelCoordinate(int32 X, int32 Y, int32 Z) const
+void AVoxelChunk::ResetChunk()
 {
-	return X >= 0 && X < ChunkSize &&
-	       Y >= 0 && Y < ChunkSize &&
-	       Z >= 0 && Z < ChunkSize;
+	LeaveRenderRegion();
+	MeshComponent->ClearAllMeshSections();
+	DirtyMeshSections = 0;
+	bPlayerEditPending = false;
+	for (uint32& Revision : MeshSectionRevisions)
+	{
+		Revision++;
+	}
+	SetVoxelCollisionEnabled(false);
+	SetCaveCulled(false);
+	MeshLodLevel = 0;
+	FaceConnectivity = VoxelCoordinates::AllFacePairs;
+	ConnectivityRevision++;
+	VoxelStorage.Init();
+	ClearActiveWaterCells();
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
 }
 
 void AVoxelChunk::SetVoxel(int32 X, int32 Y, int32 Z, EVoxelType Type)
@@ -71,7 +79,10 @@ void AVoxelChunk::SetVoxel(int32 X, int32 Y, int32 Z, EVoxelType Type)
 		return;
 
 	int32 Index = GetVoxelIndex(X, Y, Z);
-	VoxelData[Index].Type = Type;
+	FVoxelData Voxel = VoxelStorage.Get(Index);
+	Voxel.Type = Type;
+	VoxelStorage.Set(Index, Voxel);
+	ActivateWaterAround(X, Y, Z);
 }
 
 EVoxelType AVoxelChunk::GetVoxel(int32 X, int32 Y, int32 Z) const
@@ -80,190 +91,343 @@ EVoxelType AVoxelChunk::GetVoxel(int32 X, int32 Y, int32 Z) const
 		return EVoxelType::Air;
 
 	int32 Index = GetVoxelIndex(X, Y, Z);
-	return VoxelData[Index].Type;
+	return VoxelStorage.Get(Index).Type;
 }
 
-void AVoxelChunk::AddVoxelFace(
-	TArray<FVector>& Vertices,
-	TArray<int32>& Triangles,
-	TArray<FVector>& Normals,
-	TArray<FVector2D>& UVs,
-	TArray<FColor>& Colors,
-	FVector Position,
-	FVector Normal,
-	EVoxelType Type)
+uint32 AVoxelChunk::GetMeshSlabsAroundZ(int32 Z)
 {
-	int32 VertexIndex = Vertices.Num();
-	
-	// Color based on voxel type
-	FColor VoxelColor = FColor::White;
-	switch (Type)
+	// Faces between Z and its vertical neighbours belong to the slabs of both voxels
+	const int32 Below = GetMeshSlab(FMath::Max(Z - 1, 0));
+	const int32 Above = GetMeshSlab(FMath::Min(Z + 1, ChunkSize - 1));
+	return (1u << Below) | (1u << GetMeshSlab(Z)) | (1u << Above);
+}
+
+void AVoxelChunk::BuildMeshSection(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode, int32 Section, FVoxelMeshBuffers& OutBuffers)
+{
+	if (Section == WaterMeshSection)
+	{
+		FVoxelMesher::BuildMesh(Input, Mode, EVoxelMeshLayer::Water, OutBuffers);
+	}
+	else
 	{
-		case EVoxelType::Stone: VoxelColor = FColor(128, 128, 128); break;
-		case EVoxelType::Dirt: VoxelColor = FColor(139, 69, 19); break;
-		case EVoxelType::Grass: VoxelColor = FColor(34, 139, 34); break;
-		case EVoxelType::Wood: VoxelColor = FColor(160, 82, 45); break;
-		case EVoxelType::Iron: VoxelColor = FColor(192, 192, 192); break;
-		case EVoxelType::Gold: VoxelColor = FColor(255, 215, 0); break;
-		case EVoxelType::Water: VoxelColor = FColor(51, 102, 204, 153); break; // Semi-transparent blue
-		case EVoxelType::WaterSource: VoxelColor = FColor(25, 76, 230, 179); break; // Slightly darker blue
-		default: VoxelColor = FColor::White; break;
+		// Coarse cells are binned into the slab holding their lower edge; slabs without one stay empty
+		const int32 MinZ = (Section * MeshSlabHeight) >> Input.LodLevel;
+		const int32 MaxZ = ((Section + 1) * MeshSlabHeight) >> Input.LodLevel;
+		FVoxelMesher::BuildMesh(Input, Mode, EVoxelMeshLayer::Opaque, MinZ, MaxZ, OutBuffers);
 	}
+}
+
+void AVoxelChunk::MarkMeshDirty(bool bPlayerEdit)
+{
+	MarkVoxelsChanged(AllMeshSections, bPlayerEdit);
+}
 
-	// Define face vertices based on normal direction
-	FVector V1, V2, V3, V4;
-	float HalfSize = VoxelSize * 0.5f;
+void AVoxelChunk::MarkVoxelsChanged(uint32 SectionMask, bool bPlayerEdit)
+{
+	SectionMask &= AllMeshSections;
+	if (SectionMask == 0)
+		return;
+
+	const bool bWasQueued = IsMeshDirty();
 
-	if (Normal == FVector::UpVector)
+	// Collision and face connectivity follow the chunk's own solid voxels, which only the opaque slabs reflect
+	if ((SectionMask & AllMeshSlabs) != 0)
 	{
-		V1 = Position + FVector(-HalfSize, -HalfSize, HalfSize);
-		V2 = Position + FVector(HalfSize, -HalfSize, HalfSize);
-		V3 = Position + FVector(HalfSize, HalfSize, HalfSize);
-		V4 = Position + FVector(-HalfSize, HalfSize, HalfSize);
+		ConnectivityRevision++;
+		if (bVoxelCollisionEnabled)
+		{
+			CollisionRevision++;
+			bCollisionDirty = true;
+			bPlayerEditPending |= bPlayerEdit;
+		}
 	}
-	else if (Normal == FVector::DownVector)
+
+	FlagMeshSectionsDirty(SectionMask, bPlayerEdit);
+	if (!bWasQueued && IsMeshDirty())
 	{
-		V1 = Position + FVector(-HalfSize, HalfSize, -HalfSize);
-		V2 = Position + FVector(HalfSize, HalfSize, -HalfSize);
-		V3 = Position + FVector(HalfSize, -HalfSize, -HalfSize);
-		V4 = Position + FVector(-HalfSize, -HalfSize, -HalfSize);
+		RequestRebuild();
 	}
-	else if (Normal == FVector::ForwardVector)
+}
+
+void AVoxelChunk::MarkMeshSectionsDirty(uint32 SectionMask, bool bPlayerEdit)
+{
+	const bool bWasQueued = IsMeshDirty();
+	FlagMeshSectionsDirty(SectionMask & AllMeshSections, bPlayerEdit);
+	if (!bWasQueued && IsMeshDirty())
 	{
-		V1 = Position + FVector(-HalfSize, HalfSize, -HalfSize);
-		V2 = Position + FVector(-HalfSize, HalfSize, HalfSize);
-		V3 = Position + FVector(HalfSize, HalfSize, HalfSize);
-		V4 = Position + FVector(HalfSize, HalfSize, -HalfSize);
+		RequestRebuild();
 	}
-	else if (Normal == FVector::BackwardVector)
+}
+
+void AVoxelChunk::FlagMeshSectionsDirty(uint32 SectionMask, bool bPlayerEdit)
+{
+	// Without rendering there are no sections to rebuild
+	if (SectionMask == 0 || !ShouldBuildRenderMesh())
+		return;
+
+	if (MeshLodLevel > 0 && (SectionMask & AllMeshSlabs) != 0)
 	{
-		V1 = Position + FVector(HalfSize, -HalfSize, -HalfSize);
-		V2 = Position + FVector(HalfSize, -HalfSize, HalfSize);
-		V3 = Position + FVector(-HalfSize, -HalfSize, HalfSize);
-		V4 = Position + FVector(-HalfSize, -HalfSize, -HalfSize);
+		SectionMask |= AllMeshSlabs;
 	}
-	else if (Normal == FVector::RightVector)
+
+	// Any section built from older inputs is now stale, even if a rebuild is already queued
+	for (int32 Section = 0; Section < NumMeshSections; Section++)
 	{
-		V1 = Position + FVector(HalfSize, -HalfSize, -HalfSize);
-		V2 = Position + FVector(HalfSize, HalfSize, -HalfSize);
-		V3 = Position + FVector(HalfSize, HalfSize, HalfSize);
-		V4 = Position + FVector(HalfSize, -HalfSize, HalfSize);
+		if (SectionMask & (1u << Section))
+		{
+			MeshSectionRevisions[Section]++;
+		}
 	}
-	else // Left
+
+	bPlayerEditPending |= bPlayerEdit;
+	DirtyMeshSections |= SectionMask;
+
+	if ((SectionMask & AllMeshSlabs) != 0)
 	{
-		V1 = Position + FVector(-HalfSize, HalfSize, -HalfSize);
-		V2 = Position + FVector(-HalfSize, -HalfSize, -HalfSize);
-		V3 = Position + FVector(-HalfSize, -HalfSize, HalfSize);
-		V4 = Position + FVector(-HalfSize, HalfSize, HalfSize);
+		// Live-edited chunks draw themselves until they settle again, so edits never re-merge a region per rebuild.
+		// Streaming and level of detail remeshes stay merged and wait for the region's budgeted rebuild.
+		if (bPlayerEdit)
+		{
+			LeaveRenderRegion();
+		}
+		if (UWorld* World = GetWorld())
+		{
+			LastOpaqueChangeTime = World->GetTimeSeconds();
+		}
 	}
+}
 
-	// Add vertices
-	Vertices.Add(V1);
-	Vertices.Add(V2);
-	Vertices.Add(V3);
-	Vertices.Add(V4);
+void AVoxelChunk::RequestRebuild()
+{
+	// Chunks spawned outside a voxel world have no queue to wait in
+	AVoxelWorld* VoxelWorld = Cast<AVoxelWorld>(GetOwner());
+	if (VoxelWorld)
+	{
+		VoxelWorld->RequestChunkRemesh(this);
+	}
+	else
+	{
+		GenerateMesh();
+	}
+}
 
-	// Add triangles
-	Triangles.Add(VertexIndex);
-	Triangles.Add(VertexIndex + 1);
-	Triangles.Add(VertexIndex + 2);
-	Triangles.Add(VertexIndex);
-	Triangles.Add(VertexIndex + 2);
-	Triangles.Add(VertexIndex + 3);
+bool AVoxelChunk::SetMeshLodLevel(int32 LodLevel)
+{
+	LodLevel = FMath::Clamp(LodLevel, 0, FVoxelMeshInput::MaxLodLevel);
+	if (MeshLodLevel == LodLevel)
+		return false;
+
+	// Collision is built from the full-resolution voxels, which did not change; the slab rebuild refreshes face connectivity
+	MeshLodLevel = LodLevel;
+	MarkMeshSectionsDirty(AllMeshSections);
+	return true;
+}
+
+void AVoxelChunk::SetVoxelCollisionEnabled(bool bEnabled)
+{
+	if (bVoxelCollisionEnabled == bEnabled)
+		return;
 
-	// Add normals
-	for (int32 i = 0; i < 4; i++)
+	bVoxelCollisionEnabled = bEnabled;
+	CollisionRevision++;
+
+	if (bEnabled)
+	{
+		const bool bWasQueued = IsMeshDirty();
+		bCollisionDirty = true;
+		if (!bWasQueued)
+		{
+			RequestRebuild();
+		}
+	}
+	else
 	{
-		Normals.Add(Normal);
-		Colors.Add(VoxelColor);
+		bCollisionDirty = false;
+		CollisionComponent->ClearCollisionBoxes();
 	}
+}
 
-	// Add UVs
-	UVs.Add(FVector2D(0, 0));
-	UVs.Add(FVector2D(1, 0));
-	UVs.Add(FVector2D(1, 1));
-	UVs.Add(FVector2D(0, 1));
+bool AVoxelChunk::ShouldBuildRenderMesh()
+{
+	return FApp::CanEverRender();
+}
+
+void AVoxelChunk::LeaveRenderRegion()
+{
+	if (AVoxelRenderRegion* Region = RenderRegion.Get())
+	{
+		Region->RemoveMember(this);
+	}
+	RenderRegion.Reset();
+
+	// The region went away without handing the slabs back, so they have to be meshed again
+	if (bMergedIntoRegion)
+	{
+		SetMergedIntoRegion(false);
+		MarkMeshSectionsDirty(AllMeshSlabs);
+	}
+}
+
+void AVoxelChunk::SetMergedIntoRegion(bool bMerged)
+{
+	bMergedIntoRegion = bMerged;
+	RegionPendingSlabs = 0;
+	for (int32 Slab = 0; Slab < NumMeshSlabs; Slab++)
+	{
+		if (bMerged)
+		{
+			MeshComponent->ClearMeshSection(Slab);
+		}
+		else
+		{
+			MeshComponent->SetMeshSectionVisible(Slab, true);
+		}
+	}
+	UpdateMeshVisibility();
+}
+
+const FProcMeshSection* AVoxelChunk::GetOpaqueSlabSection(int32 Slab) const
+{
+	return MeshComponent->GetProcMeshSection(Slab);
+}
+
+void AVoxelChunk::UpdateMeshVisibility()
+{
+	// A hidden component leaves the scene, so merged chunks without water cost no primitive of their own
+	const FProcMeshSection* WaterSection = MeshComponent->GetProcMeshSection(WaterMeshSection);
+	const bool bHasWater = WaterSection && WaterSection->ProcIndexBuffer.Num() > 0;
+	const bool bVisible = !bCaveCulled && (!bMergedIntoRegion || bHasWater);
+	if (MeshComponent->IsVisible() != bVisible)
+	{
+		MeshComponent->SetVisibility(bVisible);
+	}
+}
+
+void AVoxelChunk::SetCaveCulled(bool bCulled)
+{
+	if (bCaveCulled == bCulled)
+		return;
+
+	bCaveCulled = bCulled;
+	UpdateMeshVisibility();
+}
+
+void AVoxelChunk::ApplyCollisionBoxes(const TArray<FBox>& Boxes)
+{
+	CollisionComponent->SetCollisionBoxes(Boxes);
+}
+
+uint32 AVoxelChunk::BeginMeshRebuild()
+{
+	const uint32 SectionMask = DirtyMeshSections;
+	DirtyMeshSections = 0;
+	bPlayerEditPending = false;
+	return SectionMask;
+}
+
+void AVoxelChunk::GatherMeshInput(FVoxelMeshInput& OutInput, bool bIncludeHalo) const
+{
+	// Meshing only reads Type and WaterLevel; the world fills the halo from loaded neighbours
+	OutInput.Init(VoxelStorage, MeshLodLevel);
+
+	const AVoxelWorld* VoxelWorld = Cast<AVoxelWorld>(GetOwner());
+	if (VoxelWorld && bIncludeHalo)
+	{
+		VoxelWorld->CopyNeighborHalo(ChunkCoordinate, OutInput);
+	}
+}
+
+void AVoxelChunk::GatherCollisionInput(FVoxelMeshInput& OutInput) const
+{
+	OutInput.Init(VoxelStorage, 0);
 }
 
 void AVoxelChunk::GenerateMesh()
 {
-	TArray<FVector> Vertices;
-	TArray<int32> Triangles;
-	TArray<FVector> Normals;
-	TArray<FVector2D> UVs;
-	TArray<FColor> Colors;
+	BeginMeshRebuild();
+	BeginCollisionRebuild();
 
-	// Generate mesh for each solid voxel
-	for (int32 Z = 0; Z < ChunkSize; Z++)
+	const bool bBuildRenderMesh = ShouldBuildRenderMesh();
+	if (!bBuildRenderMesh && !bVoxelCollisionEnabled)
+		return;
+
+	FVoxelMeshInput Input;
+	GatherMeshInput(Input, bBuildRenderMesh);
+
+	if (bBuildRenderMesh)
 	{
-		for (int32 Y = 0; Y < ChunkSize; Y++)
+		const AVoxelWorld* VoxelWorld = Cast<AVoxelWorld>(GetOwner());
+		const EVoxelMeshingMode MeshingMode = VoxelWorld ? VoxelWorld->MeshingMode : EVoxelMeshingMode::Naive;
+
+		// The component copies each section on upload, so one set of streams serves every section
+		FVoxelMeshBuffers& Buffers = FVoxelMesher::GetThreadScratchBuffers();
+		for (int32 Section = 0; Section < NumMeshSections; Section++)
 		{
-			for (int32 X = 0; X < ChunkSize; X++)
-			{
-				FVoxelData* CurrentVoxel = GetVoxelData(X, Y, Z);
-				if (!CurrentVoxel || CurrentVoxel->Type == EVoxelType::Air)
-					continue;
+			BuildMeshSection(Input, MeshingMode, Section, Buffers);
+			ApplyMeshSection(Section, Buffers);
+		}
 
-				FVector VoxelPosition = FVector(X, Y, Z) * VoxelSize;
+		FaceConnectivity = FVoxelMesher::ComputeFaceConnectivity(Input);
+	}
 
-				// Helper lambda to check if face should be rendered
-				auto ShouldRenderFace = [&](int32 NX, int32 NY, int32 NZ) -> bool
-				{
-					FVoxelData* Neighbor = GetVoxelData(NX, NY, NZ);
-					if (!Neighbor || Neighbor->IsTransparent())
-					{
-						// Don't render water faces between water blocks of same level
-						if (CurrentVoxel->IsWater() && Neighbor && Neighbor->IsWater() 
-							&& CurrentVoxel->WaterLevel == Neighbor->WaterLevel)
-						{
-							return false;
-						}
-						return true;
-					}
-					return false;
-				};
-
-				// Check each face and add if exposed to transparent block
-				if (ShouldRenderFace(X, Y, Z + 1))
-					AddVoxelFace(Vertices, Triangles, Normals, UVs, Colors, VoxelPosition, FVector::UpVector, CurrentVoxel->Type);
-				
-				if (ShouldRenderFace(X, Y, Z - 1))
-					AddVoxelFace(Vertices, Triangles, Normals, UVs, Colors, VoxelPosition, FVector::DownVector, CurrentVoxel->Type);
-				
-				if (ShouldRenderFace(X, Y + 1, Z))
-					AddVoxelFace(Vertices, Triangles, Normals, UVs, Colors, VoxelPosition, FVector::ForwardVector, CurrentVoxel->Type);
-				
-				if (ShouldRenderFace(X, Y - 1, Z))
-					AddVoxelFace(Vertices, Triangles, Normals, UVs, Colors, VoxelPosition, FVector::BackwardVector, CurrentVoxel->Type);
-				
-				if (ShouldRenderFace(X + 1, Y, Z))
-					AddVoxelFace(Vertices, Triangles, Normals, UVs, Colors, VoxelPosition, FVector::RightVector, CurrentVoxel->Type);
-				
-				if (ShouldRenderFace(X - 1, Y, Z))
-					AddVoxelFace(Vertices, Triangles, Normals, UVs, Colors, VoxelPosition, FVector::LeftVector, CurrentVoxel->Type);
-			}
+	if (bVoxelCollisionEnabled)
+	{
+		// Collision always follows the real voxels, whatever level the chunk is drawn at
+		if (Input.LodLevel > 0)
+		{
+			GatherCollisionInput(Input);
 		}
+
+		TArray<FBox> Boxes;
+		FVoxelMesher::BuildCollisionBoxes(Input, Boxes);
+		ApplyCollisionBoxes(Boxes);
 	}
+}
 
-	// Create procedural mesh
-	MeshComponent->ClearAllMeshSections();
-	if (Vertices.Num() > 0)
+void AVoxelChunk::ApplyMeshSection(int32 Section, const FVoxelMeshBuffers& Buffers)
+{
+	// Replacing one section leaves the others' geometry untouched
+	if (Buffers.IsEmpty())
+	{
+		MeshComponent->ClearMeshSection(Section);
+	}
+	else
 	{
+		// Render sections never carry collision; see ApplyCollisionBoxes
 		TArray<FProcMeshTangent> Tangents;
-		MeshComponent->CreateMeshSection(0, Vertices, Triangles, Normals, UVs, Colors, Tangents, true);
+		MeshComponent->CreateMeshSection(Section, Buffers.Vertices, Buffers.Triangles, Buffers.Normals, Buffers.UVs, Buffers.Colors, Tangents, false);
+	}
+
+	// Water appearing or drying up decides whether a merged chunk has anything left to draw
+	if (Section == WaterMeshSection)
+	{
+		UpdateMeshVisibility();
+	}
+	else if (bMergedIntoRegion)
+	{
+		// The region still draws the old slab; it takes the new one over in its next rebuild
+		MeshComponent->SetMeshSectionVisible(Section, false);
+		RegionPendingSlabs |= 1u << Section;
+		if (AVoxelRenderRegion* Region = RenderRegion.Get())
+		{
+			Region->MarkMemberChanged();
+		}
 	}
 }
 
 TArray<uint8> AVoxelChunk::SerializeVoxelData()
 {
 	TArray<uint8> Data;
-	Data.SetNum(VoxelData.Num() * 3);
+	Data.SetNum(VoxelStorage.Num() * 3);
 	
-	for (int32 i = 0; i < VoxelData.Num(); i++)
+	// Saved data is always in linear X-major order, whatever the in-memory layout
+	for (int32 i = 0; i < VoxelStorage.Num(); i++)
 	{
-		Data[i * 3] = (uint8)VoxelData[i].Type;
-		Data[i * 3 + 1] = VoxelData[i].Health;
-		Data[i * 3 + 2] = VoxelData[i].CustomData;
+		const FIntVector Local = TVoxelLinearLayout<FVoxelChunkStorage::SizeLog2>::Decode(i);
+		const FVoxelData Voxel = VoxelStorage.Get(GetVoxelIndex(Local.X, Local.Y, Local.Z));
+		Data[i * 3] = (uint8)Voxel.Type;
+		Data[i * 3 + 1] = Voxel.Health;
+		Data[i * 3 + 2] = Voxel.CustomData;
 	}
 	
 	return Data;
@@ -272,112 +436,363 @@ TArray<uint8> AVoxelChunk::SerializeVoxelData()
 void AVoxelChunk::DeserializeVoxelData(const TArray<uint8>& Data)
 {
 	int32 VoxelCount = Data.Num() / 3;
-	VoxelData.SetNum(VoxelCount);
+	if (VoxelCount != VoxelStorage.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Voxel data holds %d voxels, expected %d for a %d^3 chunk"), VoxelCount, VoxelStorage.Num(), ChunkSize);
+		return;
+	}
 	
 	for (int32 i = 0; i < VoxelCount; i++)
 	{
-		VoxelData[i].Type = (EVoxelType)Data[i * 3];
-		VoxelData[i].Health = Data[i * 3 + 1];
-		VoxelData[i].CustomData = Data[i * 3 + 2];
+		const FIntVector Local = TVoxelLinearLayout<FVoxelChunkStorage::SizeLog2>::Decode(i);
+		const int32 Index = GetVoxelIndex(Local.X, Local.Y, Local.Z);
+
+		FVoxelData Voxel = VoxelStorage.Get(Index);
+		Voxel.Type = (EVoxelType)Data[i * 3];
+		Voxel.Health = Data[i * 3 + 1];
+		Voxel.CustomData = Data[i * 3 + 2];
+		VoxelStorage.Set(Index, Voxel);
 	}
+	VoxelStorage.Compact();
+	ClearActiveWaterCells();
+	ActivateAllWaterCells();
 	
-	GenerateMesh();
+	MarkMeshDirty();
 }
 
-FVoxelData* AVoxelChunk::GetVoxelData(int32 X, int32 Y, int32 Z)
+bool AVoxelChunk::GetVoxelData(int32 X, int32 Y, int32 Z, FVoxelData& OutVoxel) const
 {
 	if (!IsValidVoxelCoordinate(X, Y, Z))
-		return nullptr;
+		return false;
 
-	int32 Index = GetVoxelIndex(X, Y, Z);
-	return &VoxelData[Index];
+	OutVoxel = VoxelStorage.Get(GetVoxelIndex(X, Y, Z));
+	return true;
+}
+
+void AVoxelChunk::SetVoxelData(int32 X, int32 Y, int32 Z, const FVoxelData& Voxel)
+{
+	if (!IsValidVoxelCoordinate(X, Y, Z))
+		return;
+
+	VoxelStorage.Set(GetVoxelIndex(X, Y, Z), Voxel);
+	ActivateWaterAround(X, Y, Z);
+}
+
+void AVoxelChunk::SetVoxelStorage(FVoxelChunkStorage&& InStorage)
+{
+	VoxelStorage = MoveTemp(InStorage);
+	ClearActiveWaterCells();
+	ActivateAllWaterCells();
+}
+
+void AVoxelChunk::CompactVoxelStorage()
+{
+	VoxelStorage.Compact();
+}
+
+int32 AVoxelChunk::GetVoxelMemoryUsage() const
+{
+	return (int32)VoxelStorage.GetAllocatedSize();
+}
+
+void AVoxelChunk::AddActiveWaterCell(int32 Index)
+{
+	if (ActiveWaterCellMask.Num() == 0)
+	{
+		ActiveWaterCellMask.Init(false, FVoxelChunkStorage::NumVoxels);
+	}
+
+	if (ActiveWaterCellMask[Index])
+		return;
+
+	if (ActiveWaterCells.Num() == 0)
+	{
+		if (AVoxelWorld* VoxelWorld = Cast<AVoxelWorld>(GetOwner()))
+		{
+			VoxelWorld->WakeChunkWater(ChunkCoordinate);
+		}
+	}
+
+	ActiveWaterCellMask[Index] = true;
+	ActiveWaterCells.Add(Index);
+}
+
+void AVoxelChunk::ClearActiveWaterCells()
+{
+	for (int32 Index : ActiveWaterCells)
+	{
+		ActiveWaterCellMask[Index] = false;
+	}
+	ActiveWaterCells.Reset();
+}
+
+void AVoxelChunk::ActivateWaterCell(int32 X, int32 Y, int32 Z)
+{
+	if (IsValidVoxelCoordinate(X, Y, Z))
+	{
+		AddActiveWaterCell(GetVoxelIndex(X, Y, Z));
+	}
+}
+
+void AVoxelChunk::ActivateWaterAround(int32 X, int32 Y, int32 Z)
+{
+	if (!IsValidVoxelCoordinate(X, Y, Z))
+		return;
+
+	AddActiveWaterCell(GetVoxelIndex(X, Y, Z));
+
+	AVoxelWorld* VoxelWorld = Cast<AVoxelWorld>(GetOwner());
+	for (const FIntVector& Direction : VoxelCoordinates::FaceDirections)
+	{
+		const FIntVector Neighbor(X + Direction.X, Y + Direction.Y, Z + Direction.Z);
+		if (IsValidVoxelCoordinate(Neighbor.X, Neighbor.Y, Neighbor.Z))
+		{
+			AddActiveWaterCell(GetVoxelIndex(Neighbor.X, Neighbor.Y, Neighbor.Z));
+		}
+		else if (VoxelWorld)
+		{
+			// Water across the border may now flow into this voxel
+			VoxelWorld->ActivateWaterAt(VoxelCoordinates::LocalToVoxel(ChunkCoordinate, Neighbor));
+		}
+	}
+}
+
+void AVoxelChunk::ActivateAllWaterCells()
+{
+	// Only water voxels act in an update, so dry chunks queue nothing
+	if (VoxelStorage.IsTypeUniform())
+	{
+		if (!IsVoxelTypeWater(VoxelStorage.GetUniformType()))
+			return;
+	}
+
+	TArray<uint8> Types;
+	VoxelStorage.DecodeTypePlane(Types);
+	for (int32 Index = 0; Index < Types.Num(); Index++)
+	{
+		if (IsVoxelTypeWater((EVoxelType)Types[Index]))
+		{
+			AddActiveWaterCell(Index);
+		}
+	}
+}
+
+void AVoxelChunk::ActivateWaterFacing(int32 Face)
+{
+	if (VoxelStorage.IsTypeUniform() && !IsVoxelTypeWater(VoxelStorage.GetUniformType()))
+		return;
+
+	// The layer is fixed on the face's axis and spans the other two
+	const int32 Axis = Face / 2;
+	const int32 Layer = VoxelCoordinates::FaceDirections[Face][Axis] > 0 ? ChunkSize - 1 : 0;
+	for (int32 V = 0; V < ChunkSize; V++)
+	{
+		for (int32 U = 0; U < ChunkSize; U++)
+		{
+			FIntVector Local;
+			Local[Axis] = Layer;
+			Local[(Axis + 1) % 3] = U;
+			Local[(Axis + 2) % 3] = V;
+
+			const int32 Index = GetVoxelIndex(Local.X, Local.Y, Local.Z);
+			if (IsVoxelTypeWater(VoxelStorage.GetType(Index)))
+			{
+				AddActiveWaterCell(Index);
+			}
+		}
+	}
 }
 
 void AVoxelChunk::UpdateWaterPhysics()
 {
-	TArray<TPair<FIntVector, FVoxelData>> WaterChanges;
+	if (!BeginWaterStep())
+		return;
+
+	TArray<FVoxelWaterWrite> Writes;
+	ComputeWaterStep(Writes);
+
+	AVoxelWorld* VoxelWorld = Cast<AVoxelWorld>(GetOwner());
+	if (VoxelWorld)
+	{
+		VoxelWorld->ApplyWaterWrites(Writes);
+		return;
+	}
+
+	// Without a world there are no neighbours, so every write lands in this chunk
+	MergeWaterWrites(Writes);
+	for (const FVoxelWaterWrite& Write : Writes)
+	{
+		const FIntVector Local = VoxelCoordinates::VoxelToLocal(Write.Voxel);
+		FVoxelData Voxel(Write.WaterLevel > 0 ? EVoxelType::Water : EVoxelType::Air);
+		Voxel.WaterLevel = Write.WaterLevel;
+		SetVoxelData(Local.X, Local.Y, Local.Z, Voxel);
+	}
+
+	if (Writes.Num() > 0)
+	{
+		MarkMeshSectionsDirty(WaterMeshSectionMask);
+	}
+}
+
+bool AVoxelChunk::BeginWaterStep()
+{
+	WaterStepCells.Reset();
+	if (ActiveWaterCells.Num() == 0)
+		return false;
+
+	// Cells changed by this step queue themselves and their neighbours for the next one
+	Swap(ActiveWaterCells, WaterStepCells);
+	for (int32 Index : WaterStepCells)
+	{
+		ActiveWaterCellMask[Index] = false;
+	}
+	return true;
+}
+
+void AVoxelChunk::ComputeWaterStep(TArray<FVoxelWaterWrite>& OutWrites) const
+{
+	OutWrites.Reset();
+
+	// Voxels in other chunks are read through the world; unloaded chunks count as solid, so water stops at them
+	const AVoxelWorld* VoxelWorld = Cast<AVoxelWorld>(GetOwner());
+	auto ReadOutsideCell = [VoxelWorld](const FIntVector& Voxel, EVoxelType& OutType, uint8& OutWaterLevel)
+	{
+		return VoxelWorld && VoxelWorld->GetWaterCell(Voxel, OutType, OutWaterLevel);
+	};
+
+	if (WaterStepCells.Num() < DenseWaterStepThreshold)
+	{
+		ProposeWaterWrites(VoxelStorage, ChunkCoordinate, WaterStepCells, ReadOutsideCell, false, OutWrites);
+		return;
+	}
+
+	// Busy chunks run the same rule over every cell at once; only border cells still look outside
+	FVoxelWaterPlanes& Planes = FVoxelWaterKernel::GetThreadPlanes();
+	const FVoxelChunkStorage* Below = VoxelWorld ? VoxelWorld->FindChunkVoxels(ChunkCoordinate - FIntVector(0, 0, 1)) : nullptr;
+	Planes.Init(VoxelStorage, WaterStepCells, Below);
+
+	TArray<uint8>& Proposals = FVoxelWaterKernel::GetThreadProposals();
+	FVoxelWaterKernel::Step(Planes, Proposals);
+	AppendWaterKernelWrites(ChunkCoordinate, Proposals, OutWrites);
+
+	ProposeWaterWrites(VoxelStorage, ChunkCoordinate, WaterStepCells, ReadOutsideCell, true, OutWrites);
+}
+
+void AVoxelChunk::ProposeWaterWrites(const FVoxelChunkStorage& Voxels, FIntVector Coordinate, const TArray<int32>& Cells, FWaterCellReader ReadOutsideCell, bool bOutsideOnly, TArray<FVoxelWaterWrite>& OutWrites)
+{
+	auto GetCell = [&Voxels, Coordinate, &ReadOutsideCell](const FIntVector& Local, EVoxelType& OutType, uint8& OutWaterLevel) -> bool
+	{
+		if (IsValidVoxelCoordinate(Local.X, Local.Y, Local.Z))
+		{
+			const int32 Index = GetVoxelIndex(Local.X, Local.Y, Local.Z);
+			OutType = Voxels.GetType(Index);
+			OutWaterLevel = Voxels.GetWaterLevel(Index);
+			return true;
+		}
+		return ReadOutsideCell(VoxelCoordinates::LocalToVoxel(Coordinate, Local), OutType, OutWaterLevel);
+	};
 
-	// Scan for water blocks
-	for (int32 X = 0; X < ChunkSize; X++)
+	for (int32 Index : Cells)
 	{
-		for (int32 Y = 0; Y < ChunkSize; Y++)
+		const EVoxelType Type = Voxels.GetType(Index);
+		if (!IsVoxelTypeWater(Type))
+			continue;
+
+		// Only border cells can reach outside the chunk
+		const FIntVector Local = FVoxelChunkStorage::Coordinate(Index);
+		if (bOutsideOnly && VoxelCoordinates::LocalToBorderFaceMask(Local) == 0)
+			continue;
+
+		const FIntVector Voxel = VoxelCoordinates::LocalToVoxel(Coordinate, Local);
+		const uint8 WaterLevel = Voxels.GetWaterLevel(Index);
+
+		auto Propose = [&OutWrites, bOutsideOnly, &Local, &Voxel](const FIntVector& Direction, uint8 Level)
 		{
-			for (int32 Z = 0; Z < ChunkSize; Z++)
+			const FIntVector Target = Local + Direction;
+			if (!bOutsideOnly || !IsValidVoxelCoordinate(Target.X, Target.Y, Target.Z))
 			{
-				FVoxelData* Voxel = GetVoxelData(X, Y, Z);
-				if (Voxel && Voxel->IsWater())
+				OutWrites.Add({ Voxel + Direction, Level });
+			}
+		};
+
+		EVoxelType BelowType;
+		uint8 BelowWaterLevel;
+
+		// Water flows down first, draining one level per step unless it is a source
+		if (GetCell(Local - FIntVector(0, 0, 1), BelowType, BelowWaterLevel) && BelowType == EVoxelType::Air)
+		{
+			Propose(FIntVector(0, 0, -1), 8);
+			if (Type != EVoxelType::WaterSource)
+			{
+				Propose(FIntVector::ZeroValue, (uint8)(WaterLevel > 0 ? WaterLevel - 1 : 0));
+			}
+		}
+		// Water spreads horizontally if can't flow down; sources are never overwritten
+		else if (WaterLevel > 1)
+		{
+			const uint8 SpreadLevel = WaterLevel - 1;
+
+			// The four horizontal directions lead VoxelCoordinates::FaceDirections
+			for (int32 Face = 0; Face < 4; Face++)
+			{
+				const FIntVector& Direction = VoxelCoordinates::FaceDirections[Face];
+
+				EVoxelType NeighborType;
+				uint8 NeighborWaterLevel;
+				if (!GetCell(Local + Direction, NeighborType, NeighborWaterLevel))
+					continue;
+
+				if (IsVoxelTypeSolid(NeighborType) || NeighborType == EVoxelType::WaterSource)
+					continue;
+
+				if (!IsVoxelTypeWater(NeighborType) || NeighborWaterLevel < SpreadLevel)
 				{
-					// Water flows down first
-					FVoxelData* Below = GetVoxelData(X, Y, Z - 1);
-					if (Below && !Below->IsSolid() && !Below->IsWater())
-					{
-						// Flow down
-						FVoxelData NewWater(EVoxelType::Water);
-						NewWater.WaterLevel = 8;
-						WaterChanges.Add(TPair<FIntVector, FVoxelData>(FIntVector(X, Y, Z - 1), NewWater));
-
-						// Reduce source water if not a source block
-						if (Voxel->Type != EVoxelType::WaterSource)
-						{
-							Voxel->WaterLevel -= 1;
-							if (Voxel->WaterLevel <= 0)
-							{
-								FVoxelData Air(EVoxelType::Air);
-								WaterChanges.Add(TPair<FIntVector, FVoxelData>(FIntVector(X, Y, Z), Air));
-							}
-						}
-					}
-					// Water spreads horizontally if can't flow down
-					else if (Voxel->WaterLevel > 1)
-					{
-						int32 SpreadLevel = Voxel->WaterLevel - 1;
-
-						// Check all 4 horizontal directions
-						TArray<FIntVector> Directions = {
-							FIntVector(1, 0, 0),
-							FIntVector(-1, 0, 0),
-							FIntVector(0, 1, 0),
-							FIntVector(0, -1, 0)
-						};
-
-						for (const FIntVector& Dir : Directions)
-						{
-							int32 NX = X + Dir.X;
-							int32 NY = Y + Dir.Y;
-							int32 NZ = Z + Dir.Z;
-
-							FVoxelData* Neighbor = GetVoxelData(NX, NY, NZ);
-							if (Neighbor && !Neighbor->IsSolid())
-							{
-								if (!Neighbor->IsWater() || Neighbor->WaterLevel < SpreadLevel)
-								{
-									FVoxelData NewWater(EVoxelType::Water);
-									NewWater.WaterLevel = SpreadLevel;
-									WaterChanges.Add(TPair<FIntVector, FVoxelData>(FIntVector(NX, NY, NZ), NewWater));
-								}
-							}
-						}
-					}
+					Propose(Direction, SpreadLevel);
 				}
 			}
 		}
 	}
+}
 
-	// Apply water changes
-	bool bMeshNeedsUpdate = false;
-	for (const TPair<FIntVector, FVoxelData>& Change : WaterChanges)
+void AVoxelChunk::AppendWaterKernelWrites(FIntVector Coordinate, const TArray<uint8>& Proposals, TArray<FVoxelWaterWrite>& OutWrites)
+{
+	// Proposals hold the level plus one, zero where nothing is written
+	for (int32 Z = 0; Z < FVoxelWaterPlanes::Size; Z++)
 	{
-		if (IsValidVoxelCoordinate(Change.Key.X, Change.Key.Y, Change.Key.Z))
+		for (int32 Y = 0; Y < FVoxelWaterPlanes::Size; Y++)
 		{
-			int32 Index = GetVoxelIndex(Change.Key.X, Change.Key.Y, Change.Key.Z);
-			VoxelData[Index] = Change.Value;
-			bMeshNeedsUpdate = true;
+			for (int32 X = 0; X < FVoxelWaterPlanes::Size; X++)
+			{
+				const uint8 Proposal = Proposals[FVoxelWaterPlanes::Index(X, Y, Z)];
+				if (Proposal > 0)
+				{
+					OutWrites.Add({ VoxelCoordinates::LocalToVoxel(Coordinate, FIntVector(X, Y, Z)), (uint8)(Proposal - 1) });
+				}
+			}
 		}
 	}
+}
 
-	// Regenerate mesh if water changed
-	if (bMeshNeedsUpdate)
+void AVoxelChunk::MergeWaterWrites(TArray<FVoxelWaterWrite>& Writes)
+{
+	Writes.Sort([](const FVoxelWaterWrite& A, const FVoxelWaterWrite& B)
 	{
-		GenerateMesh();
+		const FIntVector ChunkA = VoxelCoordinates::VoxelToChunk(A.Voxel);
+		const FIntVector ChunkB = VoxelCoordinates::VoxelToChunk(B.Voxel);
+		if (ChunkA != ChunkB)
+			return ChunkA.Z != ChunkB.Z ? ChunkA.Z < ChunkB.Z : (ChunkA.Y != ChunkB.Y ? ChunkA.Y < ChunkB.Y : ChunkA.X < ChunkB.X);
+		if (A.Voxel != B.Voxel)
+			return A.Voxel.Z != B.Voxel.Z ? A.Voxel.Z < B.Voxel.Z : (A.Voxel.Y != B.Voxel.Y ? A.Voxel.Y < B.Voxel.Y : A.Voxel.X < B.Voxel.X);
+		return A.WaterLevel > B.WaterLevel;
+	});
+
+	// Highest level first within each voxel, so keeping the first write of a run keeps the maximum
+	int32 NumKept = 0;
+	for (int32 i = 0; i < Writes.Num(); i++)
+	{
+		if (NumKept > 0 && Writes[NumKept - 1].Voxel == Writes[i].Voxel)
+			continue;
+		Writes[NumKept++] = Writes[i];
 	}
+	Writes.SetNum(NumKept, EAllowShrinking::No);
 }
@@ -6,8 +6,23 @@
 #include "GameFramework/Actor.h"
 #include "ProceduralMeshComponent.h"
 #include "VoxelData.h"
+#include "VoxelCoordinates.h"
+#include "VoxelMesher.h"
 #include "VoxelChunk.generated.h"
 
+class AVoxelRenderRegion;
+class UVoxelCollisionComponent;
+
+/** A water level proposed for one voxel by a water step, see AVoxelChunk::ComputeWaterStep */
+struct FVoxelWaterWrite
+{
+	/** Global voxel coordinate of the target */
+	FIntVector Voxel;
+
+	/** Proposed water level; 0 drains the voxel to air */
+	uint8 WaterLevel;
+};
+
 /**
  * Represents a chunk of voxels in the world
  * Chunks are the basic unit of voxel management and rendering
@@ -20,22 +35,193 @@ class VOXELSURVIVAL_API AVoxelChunk : public AActor
 public:
 	AVoxelChunk();
 
+	/** Size of chunk in voxels per dimension (compile-time, see VOXEL_CHUNK_SIZE) */
+	static constexpr int32 ChunkSize = VoxelCoordinates::ChunkSize;
+
+	/** Size of each voxel in world units (compile-time, see VOXEL_SIZE) */
+	static constexpr float VoxelSize = VoxelCoordinates::VoxelSize;
+
 	/** Size of chunk in voxels per dimension */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
-	int32 ChunkSize = 16;
+	UFUNCTION(BlueprintPure, Category = "Voxel")
+	static int32 GetChunkSize() { return ChunkSize; }
 
 	/** Size of each voxel in world units */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
-	float VoxelSize = 100.0f;
+	UFUNCTION(BlueprintPure, Category = "Voxel")
+	static float GetVoxelSize() { return VoxelSize; }
 
 	/** Chunk coordinates in world grid */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Voxel")
 	FIntVector ChunkCoordinate;
 
-	/** Generate the chunk mesh from voxel data */
+	/** Height in voxels of the Z slab covered by each mesh section */
+	static constexpr int32 MeshSlabHeight = 4;
+
+	/** Number of mesh sections per chunk, one per Z slab */
+	static constexpr int32 NumMeshSlabs = ChunkSize / MeshSlabHeight;
+
+	/** Section mask selecting every opaque slab section */
+	static constexpr uint32 AllMeshSlabs = (1u << NumMeshSlabs) - 1;
+
+	/** Mesh section holding all of the chunk's water, after the opaque slab sections */
+	static constexpr int32 WaterMeshSection = NumMeshSlabs;
+
+	/** Section mask selecting the water section */
+	static constexpr uint32 WaterMeshSectionMask = 1u << WaterMeshSection;
+
+	/** Number of mesh sections per chunk */
+	static constexpr int32 NumMeshSections = NumMeshSlabs + 1;
+
+	/** Section mask selecting every mesh section */
+	static constexpr uint32 AllMeshSections = AllMeshSlabs | WaterMeshSectionMask;
+
+	static_assert(NumMeshSections <= 32, "Mesh section masks are 32 bits wide");
+
+	/** Queued cells from which a water step evaluates the whole chunk with FVoxelWaterKernel instead of cell by cell */
+	static constexpr int32 DenseWaterStepThreshold = ChunkSize * ChunkSize * ChunkSize / 8;
+
+	/** Mesh section slab holding local Z */
+	static constexpr int32 GetMeshSlab(int32 Z) { return Z / MeshSlabHeight; }
+
+	/** Slabs whose faces can change when the voxel at local Z changes: its own, plus the adjacent one on a slab boundary */
+	static uint32 GetMeshSlabsAroundZ(int32 Z);
+
+	/** Build one mesh section: an opaque Z slab, or the water section, at the input's level of detail */
+	static void BuildMeshSection(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode, int32 Section, FVoxelMeshBuffers& OutBuffers);
+
+	/**
+	 * Whether this process draws anything; false on dedicated servers and -nullrhi runs
+	 * Without rendering chunks skip render sections, mesh caching and face connectivity
+	 * and only build simple collision straight from their voxels.
+	 */
+	static bool ShouldBuildRenderMesh();
+
+	/** Generate the chunk mesh from voxel data immediately */
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void GenerateMesh();
 
+	/**
+	 * Flag the whole mesh and the collision for a rebuild through the owning world's remesh queue,
+	 * after the chunk's voxels changed. Repeated calls before the rebuild coalesce into one.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	void MarkMeshDirty(bool bPlayerEdit = false);
+
+	/**
+	 * The chunk's own voxels changed in the given mesh sections (bit i selects section i)
+	 * Rebuilds those sections, and the collision and face connectivity if a slab changed.
+	 */
+	void MarkVoxelsChanged(uint32 SectionMask, bool bPlayerEdit = false);
+
+	/**
+	 * Flag only the given render sections for a rebuild, e.g. when a neighbour's halo changed
+	 * Collision and face connectivity only read the chunk's own voxels, so they stay as they are.
+	 */
+	void MarkMeshSectionsDirty(uint32 SectionMask, bool bPlayerEdit = false);
+
+	/**
+	 * Switch the level of detail the chunk is meshed at, 0 being full resolution
+	 * A coarse cell can straddle slab boundaries, so below full resolution every slab rebuilds together.
+	 * Only the render sections rebuild; collision always follows the full-resolution voxels.
+	 * @return True if the level changed and a rebuild was queued
+	 */
+	bool SetMeshLodLevel(int32 LodLevel);
+
+	/** Level of detail the chunk is meshed at */
+	int32 GetMeshLodLevel() const { return MeshLodLevel; }
+
+	/** Pairs of faces linked through transparent voxels, see FVoxelMesher::ComputeFaceConnectivity */
+	uint16 GetFaceConnectivity() const { return FaceConnectivity; }
+
+	/** Bumped whenever solid voxels change; connectivity computed from an older revision is stale */
+	uint32 GetConnectivityRevision() const { return ConnectivityRevision; }
+
+	/** Store the face connectivity computed with the chunk's mesh */
+	void SetFaceConnectivity(uint16 InFaceConnectivity) { FaceConnectivity = InFaceConnectivity; }
+
+	/** Hide or show the chunk mesh for cave culling; pooling hides the actor separately */
+	void SetCaveCulled(bool bCulled);
+
+	/** True while cave culling hides the chunk mesh */
+	bool IsCaveCulled() const { return bCaveCulled; }
+
+	/** Render region the chunk's opaque sections are merged into, or null while the chunk draws them itself */
+	AVoxelRenderRegion* GetRenderRegion() const { return RenderRegion.Get(); }
+
+	/** Record the render region the chunk belongs to; called by AVoxelRenderRegion */
+	void SetRenderRegion(AVoxelRenderRegion* InRenderRegion) { RenderRegion = InRenderRegion; }
+
+	/**
+	 * Leave the chunk's render region, drawing its opaque sections itself again
+	 * Only player edits split a chunk out; other remeshes stay merged, see GetRegionPendingSlabs.
+	 */
+	void LeaveRenderRegion();
+
+	/**
+	 * Hand the opaque slab sections over to the render region, or take them back
+	 * Merging clears the slab sections, so their geometry is only held by the region. A chunk without
+	 * water then has nothing left to draw and hides its whole mesh component. The region uploads the
+	 * slabs again before the chunk leaves; the water section always draws from the chunk.
+	 */
+	void SetMergedIntoRegion(bool bMerged);
+
+	/** Uploaded opaque slab section, or null if it was never built */
+	const FProcMeshSection* GetOpaqueSlabSection(int32 Slab) const;
+
+	/**
+	 * Opaque slabs rebuilt since the chunk merged into its region (bit i selects slab i)
+	 * They stay hidden on the chunk while the region draws the older geometry, until the
+	 * region's next rebuild takes them over.
+	 */
+	uint32 GetRegionPendingSlabs() const { return RegionPendingSlabs; }
+
+	/** World time the opaque sections were last flagged for a rebuild */
+	double GetLastOpaqueChangeTime() const { return LastOpaqueChangeTime; }
+
+	/** True while a mesh or collision rebuild is pending */
+	bool IsMeshDirty() const { return DirtyMeshSections != 0 || bCollisionDirty; }
+
+	/** True if the pending rebuild was caused by a player edit */
+	bool HasPendingPlayerEdit() const { return bPlayerEditPending; }
+
+	/** Bumped whenever a section's mesh inputs change; a section built from an older revision is stale */
+	uint32 GetMeshSectionRevision(int32 Section) const { return MeshSectionRevisions[Section]; }
+
+	/** Clear the dirty flags for a rebuild that starts now and return the sections it must build */
+	uint32 BeginMeshRebuild();
+
+	/**
+	 * Snapshot the voxels and neighbour halo the mesher needs; safe to hand to a worker thread
+	 * @param bIncludeHalo False leaves the halo as air, enough for collision which only reads the chunk's own cells
+	 */
+	void GatherMeshInput(FVoxelMeshInput& OutInput, bool bIncludeHalo = true) const;
+
+	/** Snapshot the voxels at full resolution without a halo, for collision of chunks rendered at a coarser level */
+	void GatherCollisionInput(FVoxelMeshInput& OutInput) const;
+
+	/** Upload a built render mesh section */
+	void ApplyMeshSection(int32 Section, const FVoxelMeshBuffers& Buffers);
+
+	/**
+	 * Turn simple collision on or off. The owning world enables it only near pawns and
+	 * physics actors; while disabled no collision is built or cooked.
+	 */
+	void SetVoxelCollisionEnabled(bool bEnabled);
+
+	/** True if the chunk keeps collision for its solid voxels */
+	bool IsVoxelCollisionEnabled() const { return bVoxelCollisionEnabled; }
+
+	/** True while the collision boxes wait for a rebuild */
+	bool IsCollisionDirty() const { return bCollisionDirty; }
+
+	/** Bumped whenever the collision inputs change; boxes built from an older revision are stale */
+	uint32 GetCollisionRevision() const { return CollisionRevision; }
+
+	/** Clear the collision dirty flag for a rebuild that starts now */
+	void BeginCollisionRebuild() { bCollisionDirty = false; }
+
+	/** Replace the chunk's simple collision with boxes in chunk space; boxes need no cooking */
+	void ApplyCollisionBoxes(const TArray<FBox>& Boxes);
+
 	/** Set voxel at local position */
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void SetVoxel(int32 X, int32 Y, int32 Z, EVoxelType Type);
@@ -48,6 +234,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void InitializeChunk(FIntVector Coordinate);
 
+	/** Clear mesh and voxels and deactivate the actor so it can be parked in the world's chunk pool */
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	void ResetChunk();
+
 	/** Serialize voxel data for saving/modding */
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	TArray<uint8> SerializeVoxelData();
@@ -56,46 +246,169 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void DeserializeVoxelData(const TArray<uint8>& Data);
 
-	/** Update water physics (Minecraft-style) */
+	/**
+	 * Step water physics (Minecraft-style) once for the cells queued since the last step
+	 * The owning world normally schedules the steps; see AVoxelWorld::UpdateWater.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Voxel|Water")
 	void UpdateWaterPhysics();
 
-	/** Get voxel data at position */
-	FVoxelData* GetVoxelData(int32 X, int32 Y, int32 Z);
+	/**
+	 * Take the queued water cells as the cells of a step that starts now
+	 * @return False if no cell is queued
+	 */
+	bool BeginWaterStep();
+
+	/**
+	 * Propose the writes of one water step for the cells taken by BeginWaterStep
+	 * Only reads voxels, here and in neighbouring chunks, so chunks can compute their steps on worker
+	 * threads in any order while nothing writes voxels. Every proposal is derived from the voxels as they
+	 * were before the step, so the outcome never depends on the order cells are visited in.
+	 * From DenseWaterStepThreshold queued cells on, writes inside the chunk come from FVoxelWaterKernel.
+	 */
+	void ComputeWaterStep(TArray<FVoxelWaterWrite>& OutWrites) const;
+
+	/**
+	 * Sort writes by chunk and voxel and keep one per voxel, the highest level
+	 * Where flows meet, the fuller one wins whichever chunk or cell proposed it first.
+	 */
+	static void MergeWaterWrites(TArray<FVoxelWaterWrite>& Writes);
+
+	/** Reads a voxel outside a chunk by global coordinate; false if its chunk is not loaded, which counts as solid */
+	typedef TFunctionRef<bool(const FIntVector& Voxel, EVoxelType& OutType, uint8& OutWaterLevel)> FWaterCellReader;
+
+	/**
+	 * The water rule of ComputeWaterStep, evaluated cell by cell: every water cell proposes its own writes
+	 * @param Cells Storage indices of the cells to evaluate
+	 * @param bOutsideOnly Only propose writes into neighbouring chunks, for steps whose interior comes from FVoxelWaterKernel
+	 */
+	static void ProposeWaterWrites(const FVoxelChunkStorage& Voxels, FIntVector Coordinate, const TArray<int32>& Cells, FWaterCellReader ReadOutsideCell, bool bOutsideOnly, TArray<FVoxelWaterWrite>& OutWrites);
+
+	/** Turn the proposal plane of FVoxelWaterKernel into writes inside the chunk */
+	static void AppendWaterKernelWrites(FIntVector Coordinate, const TArray<uint8>& Proposals, TArray<FVoxelWaterWrite>& OutWrites);
+
+	/** Queue the voxel at a local position for the next water step */
+	void ActivateWaterCell(int32 X, int32 Y, int32 Z);
+
+	/** Queue the voxel at a local position and its six neighbours, including those in neighbouring chunks, for the next water step */
+	void ActivateWaterAround(int32 X, int32 Y, int32 Z);
+
+	/** Queue every water voxel, e.g. after the chunk's voxels were replaced wholesale */
+	void ActivateAllWaterCells();
+
+	/** Queue the water voxels on the chunk layer facing VoxelCoordinates::FaceDirections[Face], e.g. once the neighbour there loads */
+	void ActivateWaterFacing(int32 Face);
+
+	/** Number of voxels queued for the next water update */
+	UFUNCTION(BlueprintCallable, Category = "Voxel|Water")
+	int32 GetNumActiveWaterCells() const { return ActiveWaterCells.Num(); }
+
+	/** Get voxel data at position, returns false if outside the chunk */
+	bool GetVoxelData(int32 X, int32 Y, int32 Z, FVoxelData& OutVoxel) const;
+
+	/** Set full voxel data at position */
+	void SetVoxelData(int32 X, int32 Y, int32 Z, const FVoxelData& Voxel);
+
+	/** Read-only access to the chunk's voxel planes */
+	const FVoxelChunkStorage& GetVoxelStorage() const { return VoxelStorage; }
+
+	/** Take ownership of voxels generated before the chunk had an actor */
+	void SetVoxelStorage(FVoxelChunkStorage&& InStorage);
+
+	/** Shrink storage after bulk edits such as terrain generation */
+	void CompactVoxelStorage();
+
+	/** Resident voxel memory in bytes (for profiling) */
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	int32 GetVoxelMemoryUsage() const;
 
 protected:
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
 
-	/** Water update timer */
-	float WaterUpdateTimer = 0.0f;
+	/**
+	 * Voxels the next water update evaluates, each listed once
+	 * A voxel is queued when it or a neighbour changes and drops off once an update leaves it
+	 * unchanged, so settled and dry chunks cost nothing.
+	 */
+	TArray<int32> ActiveWaterCells;
+
+	/** Bit per voxel, set while the voxel is in ActiveWaterCells */
+	TBitArray<> ActiveWaterCellMask;
+
+	/** Cells being evaluated by the running water update, kept for their allocation */
+	TArray<int32> WaterStepCells;
+
+	/** Queue one voxel for the next water update, waking the chunk's water in the owning world if it was asleep */
+	void AddActiveWaterCell(int32 Index);
+
+	/** Drop every queued water cell */
+	void ClearActiveWaterCells();
+
+	/** Sections waiting for a rebuild in the world's remesh queue */
+	uint32 DirtyMeshSections = 0;
+
+	/** Pending rebuild includes a player edit and should jump the queue */
+	bool bPlayerEditPending = false;
+
+	/** Mesh input revision per section, see GetMeshSectionRevision */
+	uint32 MeshSectionRevisions[NumMeshSections] = {};
+
+	/** Level of detail of the mesh, see SetMeshLodLevel */
+	int32 MeshLodLevel = 0;
+
+	/** Face connectivity from the last mesh build; everything connected until the first one */
+	uint16 FaceConnectivity = VoxelCoordinates::AllFacePairs;
+
+	/** Solid voxel revision, see GetConnectivityRevision */
+	uint32 ConnectivityRevision = 0;
+
+	/** Mesh hidden by cave culling */
+	bool bCaveCulled = false;
 
-	/** Water update interval in seconds */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel|Water")
-	float WaterUpdateInterval = 0.1f;
+	/** Opaque slab sections handed to the render region, see SetMergedIntoRegion */
+	bool bMergedIntoRegion = false;
 
-	/** Procedural mesh component for rendering */
+	/** See GetRegionPendingSlabs */
+	uint32 RegionPendingSlabs = 0;
+
+	/** Show the mesh component unless cave culling hides it or a render region draws all there is */
+	void UpdateMeshVisibility();
+
+	/** Render region merging the opaque sections, see GetRenderRegion */
+	TWeakObjectPtr<AVoxelRenderRegion> RenderRegion;
+
+	/** See GetLastOpaqueChangeTime */
+	double LastOpaqueChangeTime = 0.0;
+
+	/** Collision is wanted; chunks outside a voxel world always keep it */
+	bool bVoxelCollisionEnabled = true;
+
+	/** Collision boxes wait for a rebuild */
+	bool bCollisionDirty = false;
+
+	/** Collision input revision, see GetCollisionRevision */
+	uint32 CollisionRevision = 0;
+
+	/** Hand the chunk to the world's remesh queue, or rebuild now without a world */
+	void RequestRebuild();
+
+	/** Mark render sections stale without queueing the rebuild; shared by MarkVoxelsChanged and MarkMeshSectionsDirty */
+	void FlagMeshSectionsDirty(uint32 SectionMask, bool bPlayerEdit);
+
+	/** Procedural mesh component for rendering; never carries collision */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Voxel")
 	UProceduralMeshComponent* MeshComponent;
 
-	/** Voxel data array */
-	TArray<FVoxelData> VoxelData;
+	/** Simple collision boxes, kept apart so section uploads never rebuild the physics state */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Voxel")
+	UVoxelCollisionComponent* CollisionComponent;
+
+	/** Voxel data split into Type / WaterLevel planes with sparse Health and CustomData */
+	FVoxelChunkStorage VoxelStorage;
 
 	/** Get voxel index from coordinates */
-	int32 GetVoxelIndex(int32 X, int32 Y, int32 Z) const;
+	static constexpr int32 GetVoxelIndex(int32 X, int32 Y, int32 Z) { return FVoxelChunkStorage::Index(X, Y, Z); }
 
 	/** Check if coordinates are valid */
-	bool IsValidVoxelCoordinate(int32 X, int32 Y, int32 Z) const;
-
-	/** Create mesh face for voxel */
-	void AddVoxelFace(
-		TArray<FVector>& Vertices,
-		TArray<int32>& Triangles,
-		TArray<FVector>& Normals,
-		TArray<FVector2D>& UVs,
-		TArray<FColor>& Colors,
-		FVector Position,
-		FVector Normal,
-		EVoxelType Type
-	);
+	static constexpr bool IsValidVoxelCoordinate(int32 X, int32 Y, int32 Z) { return FVoxelChunkStorage::IsValidCoordinate(X, Y, Z); }
 };
@@ -0,0 +1,297 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelData.h"
+#include "VoxelPaletteStorage.h"
+#include "VoxelLayout.h"
+
+/** Chunk edge length in voxels; override through PublicDefinitions to try 32 or 64 voxel chunks */
+#ifndef VOXEL_CHUNK_SIZE
+#define VOXEL_CHUNK_SIZE 16
+#endif
+
+/** Set to 1 through PublicDefinitions to store chunk voxels in Morton (Z-order) layout */
+#ifndef VOXEL_CHUNK_MORTON_LAYOUT
+#define VOXEL_CHUNK_MORTON_LAYOUT 0
+#endif
+
+/**
+ * Structure-of-arrays voxel storage for a chunk with a compile-time edge length and layout
+ * Type and WaterLevel are kept in separate byte planes so meshing and water
+ * kernels only stream the bytes they read. Health and CustomData are stored
+ * sparsely because almost every voxel keeps the defaults.
+ */
+template<int32 InEdgeLength, EVoxelLayout InLayout = EVoxelLayout::Linear>
+class TVoxelChunkStorage
+{
+	static_assert(InEdgeLength == 16 || InEdgeLength == 32 || InEdgeLength == 64, "Chunk edge length must be 16, 32 or 64");
+
+public:
+	/** Edge length in voxels */
+	static constexpr int32 Size = InEdgeLength;
+
+	/** log2(Size), used for shift-based indexing */
+	static constexpr int32 SizeLog2 = InEdgeLength == 16 ? 4 : (InEdgeLength == 32 ? 5 : 6);
+
+	/** Mask extracting a local coordinate from a global voxel coordinate */
+	static constexpr int32 Mask = Size - 1;
+
+	/** Total number of voxels */
+	static constexpr int32 NumVoxels = Size * Size * Size;
+
+	/** Health value that is not stored in the sparse health plane */
+	static constexpr uint8 DefaultHealth = 100;
+
+	/** Memory layout of every plane */
+	static constexpr EVoxelLayout Layout = InLayout;
+
+	/** Index math for Layout */
+	typedef typename TVoxelLayoutSelector<InLayout, SizeLog2>::Type FLayout;
+
+	/** Plane index of a local coordinate */
+	static constexpr int32 Index(int32 X, int32 Y, int32 Z)
+	{
+		return FLayout::Encode(X, Y, Z);
+	}
+
+	/** Local coordinate of a plane index */
+	static FORCEINLINE FIntVector Coordinate(int32 InIndex)
+	{
+		return FLayout::Decode(InIndex);
+	}
+
+	/** True if a local coordinate lies inside the chunk; negative values wrap to large unsigned ones */
+	static constexpr bool IsValidCoordinate(int32 X, int32 Y, int32 Z)
+	{
+		return ((uint32)X | (uint32)Y | (uint32)Z) < (uint32)Size;
+	}
+
+	/** Linear index of a local coordinate that must lie inside the chunk */
+	static FORCEINLINE int32 CheckedIndex(int32 X, int32 Y, int32 Z)
+	{
+		checkSlow(IsValidCoordinate(X, Y, Z));
+		return Index(X, Y, Z);
+	}
+
+	TVoxelChunkStorage()
+		: NumWaterLevels(0)
+	{
+		TypePlane.Init(NumVoxels, (uint8)EVoxelType::Air);
+	}
+
+	/** Reset every voxel to FillValue */
+	void Init(const FVoxelData& FillValue = FVoxelData())
+	{
+		TypePlane.Init(NumVoxels, (uint8)FillValue.Type);
+
+		WaterLevelPlane.Empty();
+		NumWaterLevels = 0;
+		if (FillValue.WaterLevel != 0)
+		{
+			WaterLevelPlane.SetNumUninitialized(NumVoxels);
+			FMemory::Memset(WaterLevelPlane.GetData(), FillValue.WaterLevel, NumVoxels);
+			NumWaterLevels = NumVoxels;
+		}
+
+		HealthOverrides.Empty();
+		CustomDataOverrides.Empty();
+		if (FillValue.Health != DefaultHealth || FillValue.CustomData != 0)
+		{
+			for (int32 i = 0; i < NumVoxels; i++)
+			{
+				SetHealth(i, FillValue.Health);
+				SetCustomData(i, FillValue.CustomData);
+			}
+		}
+	}
+
+	/** Number of voxels stored */
+	static constexpr int32 Num() { return NumVoxels; }
+
+	/** Assemble the full voxel at linear index from all planes */
+	FVoxelData Get(int32 InIndex) const
+	{
+		FVoxelData Voxel;
+		Voxel.Type = GetType(InIndex);
+		Voxel.Health = GetHealth(InIndex);
+		Voxel.CustomData = GetCustomData(InIndex);
+		Voxel.WaterLevel = GetWaterLevel(InIndex);
+		return Voxel;
+	}
+
+	/** Scatter a full voxel into all planes */
+	void Set(int32 InIndex, const FVoxelData& Voxel)
+	{
+		SetType(InIndex, Voxel.Type);
+		SetHealth(InIndex, Voxel.Health);
+		SetCustomData(InIndex, Voxel.CustomData);
+		SetWaterLevel(InIndex, Voxel.WaterLevel);
+	}
+
+	EVoxelType GetType(int32 InIndex) const { return (EVoxelType)TypePlane.Get(InIndex); }
+	void SetType(int32 InIndex, EVoxelType Type) { TypePlane.Set(InIndex, (uint8)Type); }
+
+	uint8 GetWaterLevel(int32 InIndex) const { return WaterLevelPlane.Num() > 0 ? WaterLevelPlane[InIndex] : 0; }
+
+	void SetWaterLevel(int32 InIndex, uint8 Level)
+	{
+		check(InIndex >= 0 && InIndex < NumVoxels);
+
+		if (WaterLevelPlane.Num() == 0)
+		{
+			if (Level == 0)
+				return;
+
+			WaterLevelPlane.SetNumZeroed(NumVoxels);
+		}
+
+		const uint8 OldLevel = WaterLevelPlane[InIndex];
+		if (OldLevel == Level)
+			return;
+
+		NumWaterLevels += (Level != 0 ? 1 : 0) - (OldLevel != 0 ? 1 : 0);
+		WaterLevelPlane[InIndex] = Level;
+
+		// Drained chunks go back to holding no water plane at all
+		if (NumWaterLevels == 0)
+		{
+			WaterLevelPlane.Empty();
+		}
+	}
+
+	uint8 GetHealth(int32 InIndex) const
+	{
+		const uint8* Health = HealthOverrides.Find(InIndex);
+		return Health ? *Health : DefaultHealth;
+	}
+
+	void SetHealth(int32 InIndex, uint8 Health)
+	{
+		if (Health == DefaultHealth)
+		{
+			HealthOverrides.Remove(InIndex);
+		}
+		else
+		{
+			HealthOverrides.Add(InIndex, Health);
+		}
+	}
+
+	uint8 GetCustomData(int32 InIndex) const
+	{
+		const uint8* Data = CustomDataOverrides.Find(InIndex);
+		return Data ? *Data : 0;
+	}
+
+	void SetCustomData(int32 InIndex, uint8 Data)
+	{
+		if (Data == 0)
+		{
+			CustomDataOverrides.Remove(InIndex);
+		}
+		else
+		{
+			CustomDataOverrides.Add(InIndex, Data);
+		}
+	}
+
+	/** Unpack the Type plane into a contiguous byte array of NumVoxels entries */
+	void DecodeTypePlane(TArray<uint8>& OutTypes) const
+	{
+		OutTypes.SetNumUninitialized(NumVoxels);
+		TypePlane.Decode(OutTypes.GetData());
+	}
+
+	/** Copy the WaterLevel plane into a contiguous byte array, zero-filled when the chunk has no water */
+	void CopyWaterLevelPlane(TArray<uint8>& OutLevels) const
+	{
+		if (WaterLevelPlane.Num() > 0)
+		{
+			OutLevels = WaterLevelPlane;
+		}
+		else
+		{
+			OutLevels.SetNumZeroed(NumVoxels);
+		}
+	}
+
+	/** Direct access to the WaterLevel plane, nullptr while every level is zero */
+	const uint8* GetWaterLevelPlane() const { return WaterLevelPlane.Num() > 0 ? WaterLevelPlane.GetData() : nullptr; }
+
+	/** True if any voxel has a non-zero water level */
+	bool HasWaterLevels() const { return NumWaterLevels > 0; }
+
+	/** True when every voxel is identical: one type, no water levels, default health and custom data */
+	bool IsUniform() const
+	{
+		return TypePlane.IsUniform()
+			&& NumWaterLevels == 0
+			&& HealthOverrides.Num() == 0
+			&& CustomDataOverrides.Num() == 0;
+	}
+
+	/** True when every voxel has the same type, regardless of the other planes */
+	bool IsTypeUniform() const { return TypePlane.IsUniform(); }
+
+	/** Type shared by every voxel, only meaningful when IsTypeUniform() */
+	EVoxelType GetUniformType() const { return (EVoxelType)TypePlane.GetUniformValue(); }
+
+	/** True when every voxel is air */
+	bool IsEmpty() const { return IsTypeUniform() && GetUniformType() == EVoxelType::Air; }
+
+	/** True when no voxel is transparent */
+	bool IsFullySolid() const
+	{
+		if (IsTypeUniform())
+		{
+			return IsVoxelTypeSolid(GetUniformType());
+		}
+
+		TArray<uint8> Types;
+		DecodeTypePlane(Types);
+		for (uint8 Type : Types)
+		{
+			if (IsVoxelTypeTransparent((EVoxelType)Type))
+				return false;
+		}
+		return true;
+	}
+
+	/** Shrink the type palette after bulk edits */
+	void Compact()
+	{
+		TypePlane.Compact();
+		HealthOverrides.Compact();
+		CustomDataOverrides.Compact();
+	}
+
+	/** Heap memory used by all planes in bytes */
+	SIZE_T GetAllocatedSize() const
+	{
+		return TypePlane.GetAllocatedSize()
+			+ WaterLevelPlane.GetAllocatedSize()
+			+ HealthOverrides.GetAllocatedSize()
+			+ CustomDataOverrides.GetAllocatedSize();
+	}
+
+private:
+	/** Palette-compressed voxel types */
+	FVoxelPaletteStorage TypePlane;
+
+	/** Dense water levels, empty while every level is zero */
+	TArray<uint8> WaterLevelPlane;
+
+	/** Number of non-zero entries in WaterLevelPlane */
+	int32 NumWaterLevels;
+
+	/** Health of voxels that differ from DefaultHealth */
+	TMap<int32, uint8> HealthOverrides;
+
+	/** CustomData of voxels that differ from zero */
+	TMap<int32, uint8> CustomDataOverrides;
+};
+
+/** Chunk storage used by the game, sized by VOXEL_CHUNK_SIZE and laid out by VOXEL_CHUNK_MORTON_LAYOUT */
+typedef TVoxelChunkStorage<VOXEL_CHUNK_SIZE, VOXEL_CHUNK_MORTON_LAYOUT ? EVoxelLayout::Morton : EVoxelLayout::Linear> FVoxelChunkStorage;
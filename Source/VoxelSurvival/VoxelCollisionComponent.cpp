@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VoxelCollisionComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+
+UVoxelCollisionComponent::UVoxelCollisionComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// Collision only; nothing is ever drawn
+	SetHiddenInGame(true);
+	bVisibleInReflectionCaptures = false;
+	SetCastShadow(false);
+}
+
+void UVoxelCollisionComponent::SetCollisionBoxes(const TArray<FBox>& Boxes)
+{
+	if (!BodySetup)
+	{
+		BodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+		BodySetup->BodySetupGuid = FGuid::NewGuid();
+		BodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+		BodySetup->bGenerateMirroredCollision = false;
+	}
+
+	// Box elements are analytic shapes, so there are no physics meshes to cook
+	BodySetup->AggGeom.BoxElems.Reset(Boxes.Num());
+	LocalBounds = FBox(ForceInit);
+	for (const FBox& Box : Boxes)
+	{
+		const FVector Extent = Box.GetSize();
+		FKBoxElem& Elem = BodySetup->AggGeom.BoxElems.Emplace_GetRef(Extent.X, Extent.Y, Extent.Z);
+		Elem.Center = Box.GetCenter();
+		LocalBounds += Box;
+	}
+	BodySetup->InvalidatePhysicsData();
+	BodySetup->CreatePhysicsMeshes();
+
+	UpdateBounds();
+	RecreatePhysicsState();
+}
+
+void UVoxelCollisionComponent::ClearCollisionBoxes()
+{
+	if (BodySetup && BodySetup->AggGeom.BoxElems.Num() > 0)
+	{
+		SetCollisionBoxes(TArray<FBox>());
+	}
+}
+
+int32 UVoxelCollisionComponent::GetNumCollisionBoxes() const
+{
+	return BodySetup ? BodySetup->AggGeom.BoxElems.Num() : 0;
+}
+
+FBoxSphereBounds UVoxelCollisionComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (!LocalBounds.IsValid)
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0f);
+
+	return FBoxSphereBounds(LocalBounds).TransformBy(LocalToWorld);
+}
@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/PrimitiveComponent.h"
+#include "VoxelCollisionComponent.generated.h"
+
+class UBodySetup;
+
+/**
+ * Simple collision of a chunk as axis-aligned boxes
+ * The boxes go straight into the body setup as box elements, which the physics engine takes
+ * without cooking. Render sections live on a separate component, so remeshing never touches collision.
+ */
+UCLASS(NotBlueprintable)
+class VOXELSURVIVAL_API UVoxelCollisionComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	UVoxelCollisionComponent(const FObjectInitializer& ObjectInitializer);
+
+	/** Replace every collision box; boxes are in component space */
+	void SetCollisionBoxes(const TArray<FBox>& Boxes);
+
+	/** Remove every collision box */
+	void ClearCollisionBoxes();
+
+	/** Number of collision boxes */
+	int32 GetNumCollisionBoxes() const;
+
+	//~ Begin UPrimitiveComponent Interface
+	virtual UBodySetup* GetBodySetup() override { return BodySetup; }
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	//~ End UPrimitiveComponent Interface
+
+private:
+	/** Body setup holding the boxes, created on the first SetCollisionBoxes */
+	UPROPERTY(Transient)
+	TObjectPtr<UBodySetup> BodySetup;
+
+	/** Union of the boxes in component space */
+	FBox LocalBounds = FBox(ForceInit);
+};
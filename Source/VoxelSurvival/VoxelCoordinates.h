@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelChunkStorage.h"
+
+/** Size of each voxel in world units */
+#ifndef VOXEL_SIZE
+#define VOXEL_SIZE 100.0f
+#endif
+
+/**
+ * World, chunk and local voxel coordinate conversions
+ * Everything derives from the compile-time chunk dimensions so chunks and the
+ * world can never disagree about chunk or voxel size.
+ */
+namespace VoxelCoordinates
+{
+	/** Chunk edge length in voxels */
+	constexpr int32 ChunkSize = FVoxelChunkStorage::Size;
+
+	/** log2(ChunkSize) */
+	constexpr int32 ChunkSizeLog2 = FVoxelChunkStorage::SizeLog2;
+
+	/** Size of each voxel in world units */
+	constexpr float VoxelSize = VOXEL_SIZE;
+
+	/** Size of a chunk in world units */
+	constexpr float ChunkWorldSize = ChunkSize * VoxelSize;
+
+	/** Global voxel coordinate containing a world position */
+	FORCEINLINE FIntVector WorldToVoxel(const FVector& WorldPosition)
+	{
+		return FIntVector(
+			FMath::FloorToInt(WorldPosition.X / VoxelSize),
+			FMath::FloorToInt(WorldPosition.Y / VoxelSize),
+			FMath::FloorToInt(WorldPosition.Z / VoxelSize)
+		);
+	}
+
+	/** Chunk containing a global voxel coordinate; the arithmetic shift floors negative coordinates */
+	FORCEINLINE FIntVector VoxelToChunk(const FIntVector& Voxel)
+	{
+		return FIntVector(Voxel.X >> ChunkSizeLog2, Voxel.Y >> ChunkSizeLog2, Voxel.Z >> ChunkSizeLog2);
+	}
+
+	/** Local coordinate of a global voxel coordinate inside its chunk */
+	FORCEINLINE FIntVector VoxelToLocal(const FIntVector& Voxel)
+	{
+		return FIntVector(Voxel.X & FVoxelChunkStorage::Mask, Voxel.Y & FVoxelChunkStorage::Mask, Voxel.Z & FVoxelChunkStorage::Mask);
+	}
+
+	/** Global voxel coordinate of a local coordinate in a chunk; local coordinates may lie outside the chunk */
+	FORCEINLINE FIntVector LocalToVoxel(const FIntVector& ChunkCoordinate, const FIntVector& Local)
+	{
+		return FIntVector(
+			(ChunkCoordinate.X << ChunkSizeLog2) + Local.X,
+			(ChunkCoordinate.Y << ChunkSizeLog2) + Local.Y,
+			(ChunkCoordinate.Z << ChunkSizeLog2) + Local.Z
+		);
+	}
+
+	/** Chunk containing a world position */
+	FORCEINLINE FIntVector WorldToChunk(const FVector& WorldPosition)
+	{
+		return VoxelToChunk(WorldToVoxel(WorldPosition));
+	}
+
+	/** World position of a chunk's origin corner */
+	FORCEINLINE FVector ChunkToWorld(const FIntVector& ChunkCoordinate)
+	{
+		return FVector(ChunkCoordinate) * ChunkWorldSize;
+	}
+
+	/** Offsets to the six face-adjacent chunks, in face-mask bit order */
+	inline const FIntVector FaceDirections[6] = {
+		FIntVector(1, 0, 0),
+		FIntVector(-1, 0, 0),
+		FIntVector(0, 1, 0),
+		FIntVector(0, -1, 0),
+		FIntVector(0, 0, 1),
+		FIntVector(0, 0, -1)
+	};
+
+	/** Bit i is set when a local coordinate lies on the chunk layer facing FaceDirections[i] */
+	FORCEINLINE uint8 LocalToBorderFaceMask(const FIntVector& Local)
+	{
+		constexpr int32 Last = ChunkSize - 1;
+		return (Local.X == Last ? 1 : 0) | (Local.X == 0 ? 2 : 0)
+			| (Local.Y == Last ? 4 : 0) | (Local.Y == 0 ? 8 : 0)
+			| (Local.Z == Last ? 16 : 0) | (Local.Z == 0 ? 32 : 0);
+	}
+
+	/** Index of the face opposite FaceDirections[Face] */
+	constexpr int32 OppositeFace(int32 Face)
+	{
+		return Face ^ 1;
+	}
+
+	/** Bit of the unordered pair of two different faces in a 15-bit face connectivity mask */
+	constexpr int32 FacePairBit(int32 FaceA, int32 FaceB)
+	{
+		const int32 Low = FaceA < FaceB ? FaceA : FaceB;
+		const int32 High = FaceA < FaceB ? FaceB : FaceA;
+		return Low * 6 + High - (Low + 1) * (Low + 2) / 2;
+	}
+
+	/** Face connectivity mask with every pair of faces connected */
+	constexpr uint16 AllFacePairs = 0x7FFF;
+}
@@ -20,6 +20,22 @@ enum class EVoxelType : uint8
 	Custom UMETA(DisplayName = "Custom")
 };
 
+/** Type queries shared by FVoxelData and the per-plane chunk kernels */
+FORCEINLINE bool IsVoxelTypeWater(EVoxelType Type)
+{
+	return Type == EVoxelType::Water || Type == EVoxelType::WaterSource;
+}
+
+FORCEINLINE bool IsVoxelTypeTransparent(EVoxelType Type)
+{
+	return Type == EVoxelType::Air || IsVoxelTypeWater(Type);
+}
+
+FORCEINLINE bool IsVoxelTypeSolid(EVoxelType Type)
+{
+	return !IsVoxelTypeTransparent(Type);
+}
+
 /** Represents a single voxel in the world */
 struct FVoxelData
 {
@@ -44,16 +60,29 @@ struct FVoxelData
 
 	bool IsSolid() const
 	{
-		return Type != EVoxelType::Air && Type != EVoxelType::Water && Type != EVoxelType::WaterSource;
+		return IsVoxelTypeSolid(Type);
 	}
 
 	bool IsTransparent() const
 	{
-		return Type == EVoxelType::Air || Type == EVoxelType::Water || Type == EVoxelType::WaterSource;
+		return IsVoxelTypeTransparent(Type);
 	}
 
 	bool IsWater() const
 	{
-		return Type == EVoxelType::Water || Type == EVoxelType::WaterSource;
+		return IsVoxelTypeWater(Type);
+	}
+
+	bool operator==(const FVoxelData& Other) const
+	{
+		return Type == Other.Type
+			&& Health == Other.Health
+			&& CustomData == Other.CustomData
+			&& WaterLevel == Other.WaterLevel;
+	}
+
+	bool operator!=(const FVoxelData& Other) const
+	{
+		return !(*this == Other);
 	}
 };
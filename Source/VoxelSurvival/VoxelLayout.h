@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Order in which a chunk's voxels are laid out in memory */
+enum class EVoxelLayout : uint8
+{
+	/** X fastest, then Y, then Z: X + Y*N + Z*N*N */
+	Linear,
+
+	/** Morton / Z-order curve interleaving the bits of X, Y and Z */
+	Morton
+};
+
+/** Linear layout index math for chunks of edge 2^SizeLog2 */
+template<int32 SizeLog2>
+struct TVoxelLinearLayout
+{
+	static constexpr int32 Mask = (1 << SizeLog2) - 1;
+
+	static constexpr int32 Encode(int32 X, int32 Y, int32 Z)
+	{
+		return X | (Y << SizeLog2) | (Z << (2 * SizeLog2));
+	}
+
+	static FORCEINLINE FIntVector Decode(int32 Index)
+	{
+		return FIntVector(Index & Mask, (Index >> SizeLog2) & Mask, Index >> (2 * SizeLog2));
+	}
+};
+
+/**
+ * Morton (Z-order) index math for chunks of edge 2^SizeLog2
+ * Neighbours along any axis stay within a few cache lines for most voxels,
+ * where the linear layout puts ±Z neighbours N*N entries apart.
+ */
+template<int32 SizeLog2>
+struct TVoxelMortonLayout
+{
+	static_assert(SizeLog2 <= 10, "Morton encoding supports at most 10 bits per axis");
+
+	/** Insert two zero bits between each of the low 10 bits */
+	static constexpr uint32 SpreadBits(uint32 Value)
+	{
+		Value &= 0x000003FF;
+		Value = (Value | (Value << 16)) & 0x030000FF;
+		Value = (Value | (Value << 8)) & 0x0300F00F;
+		Value = (Value | (Value << 4)) & 0x030C30C3;
+		Value = (Value | (Value << 2)) & 0x09249249;
+		return Value;
+	}
+
+	/** Inverse of SpreadBits: gather every third bit into the low 10 bits */
+	static constexpr uint32 CompactBits(uint32 Value)
+	{
+		Value &= 0x09249249;
+		Value = (Value | (Value >> 2)) & 0x030C30C3;
+		Value = (Value | (Value >> 4)) & 0x0300F00F;
+		Value = (Value | (Value >> 8)) & 0x030000FF;
+		Value = (Value | (Value >> 16)) & 0x000003FF;
+		return Value;
+	}
+
+	static constexpr int32 Encode(int32 X, int32 Y, int32 Z)
+	{
+		return (int32)(SpreadBits((uint32)X) | (SpreadBits((uint32)Y) << 1) | (SpreadBits((uint32)Z) << 2));
+	}
+
+	static FORCEINLINE FIntVector Decode(int32 Index)
+	{
+		return FIntVector(
+			(int32)CompactBits((uint32)Index),
+			(int32)CompactBits((uint32)Index >> 1),
+			(int32)CompactBits((uint32)Index >> 2)
+		);
+	}
+};
+
+/** Maps an EVoxelLayout to its index math */
+template<EVoxelLayout Layout, int32 SizeLog2>
+struct TVoxelLayoutSelector;
+
+template<int32 SizeLog2>
+struct TVoxelLayoutSelector<EVoxelLayout::Linear, SizeLog2>
+{
+	typedef TVoxelLinearLayout<SizeLog2> Type;
+};
+
+template<int32 SizeLog2>
+struct TVoxelLayoutSelector<EVoxelLayout::Morton, SizeLog2>
+{
+	typedef TVoxelMortonLayout<SizeLog2> Type;
+};
@@ -0,0 +1,178 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "VoxelChunkStorage.h"
+
+/**
+ * Microbenchmark comparing the linear and Morton chunk layouts
+ * Run "voxel.BenchmarkLayouts [Iterations]" from the console on the target
+ * platform. Both layouts are timed on the access patterns the game relies on:
+ * six-neighbour face culling (meshing), below/horizontal lookups around water
+ * voxels (water kernel) and random single-voxel reads.
+ */
+namespace VoxelLayoutBenchmark
+{
+	struct FTimings
+	{
+		double MeshingMs = 0.0;
+		double WaterMs = 0.0;
+		double RandomMs = 0.0;
+		int64 Checksum = 0;
+	};
+
+	/** Fill the planes with rolling terrain under a water line, identically for every layout */
+	template<typename StorageType>
+	void FillPlanes(TArray<uint8>& Types, TArray<uint8>& WaterLevels)
+	{
+		constexpr int32 Size = StorageType::Size;
+		const int32 WaterLine = Size / 2 + 1;
+
+		Types.SetNumZeroed(StorageType::NumVoxels);
+		WaterLevels.SetNumZeroed(StorageType::NumVoxels);
+
+		for (int32 Z = 0; Z < Size; Z++)
+		{
+			for (int32 Y = 0; Y < Size; Y++)
+			{
+				for (int32 X = 0; X < Size; X++)
+				{
+					const int32 Height = Size / 2 + FMath::RoundToInt(FMath::Sin(X * 0.4f) * 3.0f + FMath::Cos(Y * 0.3f) * 3.0f);
+					const int32 Index = StorageType::Index(X, Y, Z);
+
+					EVoxelType Type = EVoxelType::Air;
+					if (Z < Height - 3)
+					{
+						Type = EVoxelType::Stone;
+					}
+					else if (Z < Height)
+					{
+						Type = Z == Height - 1 ? EVoxelType::Grass : EVoxelType::Dirt;
+					}
+					else if (Z < WaterLine)
+					{
+						Type = EVoxelType::Water;
+						WaterLevels[Index] = 8 - (uint8)FMath::Min(WaterLine - Z, 7);
+					}
+
+					Types[Index] = (uint8)Type;
+				}
+			}
+		}
+	}
+
+	template<typename StorageType>
+	FTimings Run(int32 Iterations)
+	{
+		TArray<uint8> TypePlane;
+		TArray<uint8> WaterPlane;
+		FillPlanes<StorageType>(TypePlane, WaterPlane);
+
+		const uint8* Types = TypePlane.GetData();
+		const uint8* WaterLevels = WaterPlane.GetData();
+
+		auto IsTransparentAt = [Types](int32 X, int32 Y, int32 Z) -> int32
+		{
+			return !StorageType::IsValidCoordinate(X, Y, Z) || IsVoxelTypeTransparent((EVoxelType)Types[StorageType::Index(X, Y, Z)]) ? 1 : 0;
+		};
+
+		FTimings Timings;
+
+		// Meshing: count exposed faces of every non-air voxel, walking voxels in storage order
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			for (int32 Index = 0; Index < StorageType::NumVoxels; Index++)
+			{
+				if (Types[Index] == (uint8)EVoxelType::Air)
+					continue;
+
+				const FIntVector P = StorageType::Coordinate(Index);
+				Timings.Checksum += IsTransparentAt(P.X + 1, P.Y, P.Z) + IsTransparentAt(P.X - 1, P.Y, P.Z)
+					+ IsTransparentAt(P.X, P.Y + 1, P.Z) + IsTransparentAt(P.X, P.Y - 1, P.Z)
+					+ IsTransparentAt(P.X, P.Y, P.Z + 1) + IsTransparentAt(P.X, P.Y, P.Z - 1);
+			}
+		}
+		Timings.MeshingMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+		// Water: the cell below, then the four horizontal neighbours of every water voxel
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			for (int32 Index = 0; Index < StorageType::NumVoxels; Index++)
+			{
+				if (!IsVoxelTypeWater((EVoxelType)Types[Index]))
+					continue;
+
+				const FIntVector P = StorageType::Coordinate(Index);
+				if (StorageType::IsValidCoordinate(P.X, P.Y, P.Z - 1) && Types[StorageType::Index(P.X, P.Y, P.Z - 1)] == (uint8)EVoxelType::Air)
+				{
+					Timings.Checksum++;
+					continue;
+				}
+
+				const FIntVector Horizontal[4] = {
+					FIntVector(P.X + 1, P.Y, P.Z), FIntVector(P.X - 1, P.Y, P.Z),
+					FIntVector(P.X, P.Y + 1, P.Z), FIntVector(P.X, P.Y - 1, P.Z)
+				};
+				for (const FIntVector& N : Horizontal)
+				{
+					if (StorageType::IsValidCoordinate(N.X, N.Y, N.Z))
+					{
+						Timings.Checksum += WaterLevels[StorageType::Index(N.X, N.Y, N.Z)] < WaterLevels[Index] ? 1 : 0;
+					}
+				}
+			}
+		}
+		Timings.WaterMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+		// Random access: coordinates are generated up front so only the lookups are timed
+		FRandomStream Random(12345);
+		TArray<FIntVector> Coordinates;
+		Coordinates.SetNumUninitialized(StorageType::NumVoxels);
+		for (FIntVector& Coordinate : Coordinates)
+		{
+			Coordinate = FIntVector(
+				Random.RandRange(0, StorageType::Size - 1),
+				Random.RandRange(0, StorageType::Size - 1),
+				Random.RandRange(0, StorageType::Size - 1)
+			);
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			for (const FIntVector& Coordinate : Coordinates)
+			{
+				Timings.Checksum += Types[StorageType::Index(Coordinate.X, Coordinate.Y, Coordinate.Z)];
+			}
+		}
+		Timings.RandomMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+		return Timings;
+	}
+}
+
+static void RunVoxelLayoutBenchmark(const TArray<FString>& Args)
+{
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+
+	const VoxelLayoutBenchmark::FTimings Linear = VoxelLayoutBenchmark::Run<TVoxelChunkStorage<VOXEL_CHUNK_SIZE, EVoxelLayout::Linear>>(Iterations);
+	const VoxelLayoutBenchmark::FTimings Morton = VoxelLayoutBenchmark::Run<TVoxelChunkStorage<VOXEL_CHUNK_SIZE, EVoxelLayout::Morton>>(Iterations);
+
+	UE_LOG(LogTemp, Log, TEXT("Voxel layout benchmark: %d^3 chunk, %d iterations, ms per pass"), VOXEL_CHUNK_SIZE, Iterations);
+	UE_LOG(LogTemp, Log, TEXT("  Linear  meshing %.4f  water %.4f  random %.4f"), Linear.MeshingMs, Linear.WaterMs, Linear.RandomMs);
+	UE_LOG(LogTemp, Log, TEXT("  Morton  meshing %.4f  water %.4f  random %.4f"), Morton.MeshingMs, Morton.WaterMs, Morton.RandomMs);
+
+	if (Linear.Checksum != Morton.Checksum)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("  Layouts produced different results (%lld vs %lld)"), Linear.Checksum, Morton.Checksum);
+	}
+}
+
+static FAutoConsoleCommand VoxelLayoutBenchmarkCommand(
+	TEXT("voxel.BenchmarkLayouts"),
+	TEXT("Time linear vs Morton chunk layouts on meshing, water and random access. Usage: voxel.BenchmarkLayouts [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunVoxelLayoutBenchmark)
+);
@@ -0,0 +1,78 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VoxelMeshCache.h"
+#include "Hash/CityHash.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+
+FVoxelMeshCache::FVoxelMeshCache(int32 InMaxEntries)
+	: Entries(FMath::Max(InMaxEntries, 1))
+	, MaxEntries(FMath::Max(InMaxEntries, 1))
+	, NumHits(0)
+	, NumMisses(0)
+{
+}
+
+FVoxelMeshCache::FInputDigest FVoxelMeshCache::DigestInput(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode)
+{
+	const uint64 Seed = (uint64)Input.LodLevel | ((uint64)Mode << 8);
+
+	FInputDigest Digest;
+	const uint64 TypesHash = CityHash64WithSeed((const char*)Input.Types.GetData(), Input.Types.Num(), Seed);
+	Digest.Hash = CityHash64WithSeed((const char*)Input.WaterLevels.GetData(), Input.WaterLevels.Num(), TypesHash);
+
+	// CityHash seeds only mix into the final step, so the check uses a different function altogether
+	const uint32 TypesCrc = FCrc::MemCrc32(Input.Types.GetData(), Input.Types.Num(), (uint32)Seed);
+	const uint32 WaterLevelsCrc = FCrc::MemCrc32(Input.WaterLevels.GetData(), Input.WaterLevels.Num(), TypesCrc);
+	Digest.CheckHash = ((uint64)TypesCrc << 32) | WaterLevelsCrc;
+	return Digest;
+}
+
+FVoxelMeshCache::FSharedBuffers FVoxelMeshCache::Find(const FInputDigest& Digest, int32 Section)
+{
+	FScopeLock ScopeLock(&Lock);
+	const FEntry* Entry = Entries.FindAndTouch(FKey{ Digest.Hash, Section });
+	if (Entry && Entry->CheckHash == Digest.CheckHash)
+	{
+		NumHits++;
+		return Entry->Buffers;
+	}
+
+	// A key collision counts as a miss; the rebuilt section then replaces the entry
+	NumMisses++;
+	return FSharedBuffers();
+}
+
+FVoxelMeshCache::FSharedBuffers FVoxelMeshCache::Add(const FInputDigest& Digest, int32 Section, FVoxelMeshBuffers&& Buffers)
+{
+	FSharedBuffers Shared = MakeShared<FVoxelMeshBuffers, ESPMode::ThreadSafe>(MoveTemp(Buffers));
+
+	FScopeLock ScopeLock(&Lock);
+	Entries.Add(FKey{ Digest.Hash, Section }, FEntry{ Digest.CheckHash, Shared });
+	return Shared;
+}
+
+int32 FVoxelMeshCache::Num() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Entries.Num();
+}
+
+int64 FVoxelMeshCache::GetNumHits() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumHits;
+}
+
+int64 FVoxelMeshCache::GetNumMisses() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumMisses;
+}
+
+void FVoxelMeshCache::ResetStats()
+{
+	FScopeLock ScopeLock(&Lock);
+	NumHits = 0;
+	NumMisses = 0;
+}
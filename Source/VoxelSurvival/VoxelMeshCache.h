@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "HAL/CriticalSection.h"
+#include "VoxelMesher.h"
+
+/**
+ * Bounded cache of built mesh sections keyed by the content of their mesh input
+ * Plains, lake bottoms and solid cross-sections produce bit-identical inputs,
+ * halo included, and with it identical chunk-space geometry. Chunks like that
+ * share one cached copy of each section and skip meshing. The least recently
+ * used entries are evicted first. All functions are safe to call from mesh workers.
+ */
+class VOXELSURVIVAL_API FVoxelMeshCache
+{
+public:
+	explicit FVoxelMeshCache(int32 InMaxEntries);
+
+	/** Cached sections are shared with every chunk drawing them and never change once added */
+	typedef TSharedPtr<const FVoxelMeshBuffers, ESPMode::ThreadSafe> FSharedBuffers;
+
+	/**
+	 * Digest of everything a section build reads: both padded planes, the level of detail and the meshing mode
+	 * Hash keys the cache. CheckHash comes from an unrelated hash function and is stored with each entry,
+	 * so two inputs whose keys collide are told apart instead of one drawing the other's mesh. The planes
+	 * always have FVoxelMeshInput::NumCells cells, so their size needs no check of its own.
+	 */
+	struct FInputDigest
+	{
+		uint64 Hash = 0;
+		uint64 CheckHash = 0;
+	};
+
+	/** Digest a mesh input for Find and Add */
+	static FInputDigest DigestInput(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode);
+
+	/** The cached section of an input, or null on a miss */
+	FSharedBuffers Find(const FInputDigest& Digest, int32 Section);
+
+	/**
+	 * Store a freshly built section, evicting the least recently used entry when full
+	 * @param Buffers Moved into the cache, so nothing is copied
+	 * @return The cached section, to upload from
+	 */
+	FSharedBuffers Add(const FInputDigest& Digest, int32 Section, FVoxelMeshBuffers&& Buffers);
+
+	/** Number of sections currently cached */
+	int32 Num() const;
+
+	/** Maximum number of sections kept */
+	int32 GetMaxEntries() const { return MaxEntries; }
+
+	/** Lookups answered from the cache since the last ResetStats */
+	int64 GetNumHits() const;
+
+	/** Lookups that had to mesh since the last ResetStats */
+	int64 GetNumMisses() const;
+
+	/** Zero the hit and miss counters */
+	void ResetStats();
+
+private:
+	struct FKey
+	{
+		uint64 InputHash;
+		int32 Section;
+
+		bool operator==(const FKey& Other) const
+		{
+			return InputHash == Other.InputHash && Section == Other.Section;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.InputHash), GetTypeHash(Key.Section));
+		}
+	};
+
+	struct FEntry
+	{
+		/** FInputDigest::CheckHash of the input the section was built from */
+		uint64 CheckHash;
+
+		FSharedBuffers Buffers;
+	};
+
+	mutable FCriticalSection Lock;
+	TLruCache<FKey, FEntry> Entries;
+	int32 MaxEntries;
+	int64 NumHits;
+	int64 NumMisses;
+};
@@ -0,0 +1,627 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VoxelMesher.h"
+
+void FVoxelMeshInput::Init(const FVoxelChunkStorage& Voxels, int32 InLodLevel)
+{
+	check(InLodLevel >= 0 && InLodLevel <= MaxLodLevel);
+	LodLevel = InLodLevel;
+
+	Types.Init((uint8)EVoxelType::Air, NumCells);
+	WaterLevels.Init(0, NumCells);
+
+	TArray<uint8> ChunkTypes;
+	Voxels.DecodeTypePlane(ChunkTypes);
+	const uint8* ChunkWaterLevels = Voxels.GetWaterLevelPlane();
+
+	if (LodLevel > 0)
+	{
+		const int32 CellCount = GetCellCount();
+		for (int32 Z = 0; Z < CellCount; Z++)
+		{
+			for (int32 Y = 0; Y < CellCount; Y++)
+			{
+				for (int32 X = 0; X < CellCount; X++)
+				{
+					DownsampleBlock(ChunkTypes.GetData(), ChunkWaterLevels, FIntVector(X, Y, Z), Index(X, Y, Z));
+				}
+			}
+		}
+		return;
+	}
+
+	for (int32 Z = 0; Z < Size; Z++)
+	{
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const int32 ChunkIndex = FVoxelChunkStorage::Index(X, Y, Z);
+				const int32 CellIndex = Index(X, Y, Z);
+				Types[CellIndex] = ChunkTypes[ChunkIndex];
+				if (ChunkWaterLevels)
+				{
+					WaterLevels[CellIndex] = ChunkWaterLevels[ChunkIndex];
+				}
+			}
+		}
+	}
+}
+
+void FVoxelMeshInput::CopyNeighborLayer(const FVoxelChunkStorage& Neighbor, const FIntVector& FaceDirection)
+{
+	const uint8* NeighborWaterLevels = Neighbor.GetWaterLevelPlane();
+
+	// Downsample the neighbour's touching cell layer exactly as the neighbour would, so equal levels cull seamlessly
+	if (LodLevel > 0)
+	{
+		TArray<uint8> NeighborTypes;
+		Neighbor.DecodeTypePlane(NeighborTypes);
+
+		const int32 CellCount = GetCellCount();
+		for (int32 A = 0; A < CellCount; A++)
+		{
+			for (int32 B = 0; B < CellCount; B++)
+			{
+				const int32 X = FaceDirection.X != 0 ? (FaceDirection.X > 0 ? 0 : CellCount - 1) : A;
+				const int32 Y = FaceDirection.Y != 0 ? (FaceDirection.Y > 0 ? 0 : CellCount - 1) : (FaceDirection.X != 0 ? A : B);
+				const int32 Z = FaceDirection.Z != 0 ? (FaceDirection.Z > 0 ? 0 : CellCount - 1) : B;
+
+				const int32 CellIndex = Index(X + FaceDirection.X * CellCount, Y + FaceDirection.Y * CellCount, Z + FaceDirection.Z * CellCount);
+				DownsampleBlock(NeighborTypes.GetData(), NeighborWaterLevels, FIntVector(X, Y, Z), CellIndex);
+			}
+		}
+		return;
+	}
+
+	for (int32 A = 0; A < Size; A++)
+	{
+		for (int32 B = 0; B < Size; B++)
+		{
+			// Pin the face axis to the neighbour layer touching this chunk, sweep the other two
+			const int32 X = FaceDirection.X != 0 ? (FaceDirection.X > 0 ? 0 : Size - 1) : A;
+			const int32 Y = FaceDirection.Y != 0 ? (FaceDirection.Y > 0 ? 0 : Size - 1) : (FaceDirection.X != 0 ? A : B);
+			const int32 Z = FaceDirection.Z != 0 ? (FaceDirection.Z > 0 ? 0 : Size - 1) : B;
+
+			// Seen from this chunk the same voxel sits one step past the border
+			const int32 NeighborIndex = FVoxelChunkStorage::Index(X, Y, Z);
+			const int32 CellIndex = Index(X + FaceDirection.X * Size, Y + FaceDirection.Y * Size, Z + FaceDirection.Z * Size);
+
+			Types[CellIndex] = (uint8)Neighbor.GetType(NeighborIndex);
+			WaterLevels[CellIndex] = NeighborWaterLevels ? NeighborWaterLevels[NeighborIndex] : 0;
+		}
+	}
+}
+
+void FVoxelMeshInput::DownsampleBlock(const uint8* ChunkTypes, const uint8* ChunkWaterLevels, const FIntVector& Cell, int32 CellIndex)
+{
+	const int32 BlockSize = 1 << LodLevel;
+	const FIntVector Origin = Cell * BlockSize;
+
+	int32 NumSolid = 0;
+	int32 NumWater = 0;
+	uint8 SurfaceType = (uint8)EVoxelType::Air;
+	uint8 WaterType = (uint8)EVoxelType::Air;
+	uint8 MaxWaterLevel = 0;
+
+	// Top-down, so the first solid and water voxels found are the ones seen from above
+	for (int32 Z = BlockSize - 1; Z >= 0; Z--)
+	{
+		for (int32 Y = 0; Y < BlockSize; Y++)
+		{
+			for (int32 X = 0; X < BlockSize; X++)
+			{
+				const int32 VoxelIndex = FVoxelChunkStorage::Index(Origin.X + X, Origin.Y + Y, Origin.Z + Z);
+				const EVoxelType Type = (EVoxelType)ChunkTypes[VoxelIndex];
+				if (IsVoxelTypeSolid(Type))
+				{
+					SurfaceType = NumSolid == 0 ? (uint8)Type : SurfaceType;
+					NumSolid++;
+				}
+				else if (IsVoxelTypeWater(Type))
+				{
+					WaterType = NumWater == 0 ? (uint8)Type : WaterType;
+					MaxWaterLevel = ChunkWaterLevels ? FMath::Max(MaxWaterLevel, ChunkWaterLevels[VoxelIndex]) : MaxWaterLevel;
+					NumWater++;
+				}
+			}
+		}
+	}
+
+	const int32 HalfBlock = BlockSize * BlockSize * BlockSize / 2;
+	if (NumSolid >= HalfBlock)
+	{
+		Types[CellIndex] = SurfaceType;
+		WaterLevels[CellIndex] = 0;
+	}
+	else if (NumWater > 0 && NumSolid + NumWater >= HalfBlock)
+	{
+		Types[CellIndex] = WaterType;
+		WaterLevels[CellIndex] = MaxWaterLevel;
+	}
+	else
+	{
+		Types[CellIndex] = (uint8)EVoxelType::Air;
+		WaterLevels[CellIndex] = 0;
+	}
+}
+
+void FVoxelMeshBuffers::Reset()
+{
+	Vertices.Reset();
+	Triangles.Reset();
+	Normals.Reset();
+	UVs.Reset();
+	Colors.Reset();
+}
+
+void FVoxelMeshBuffers::SetNumQuadsUninitialized(int32 NumQuads)
+{
+	Vertices.SetNumUninitialized(NumQuads * 4, EAllowShrinking::No);
+	Triangles.SetNumUninitialized(NumQuads * 6, EAllowShrinking::No);
+	Normals.SetNumUninitialized(NumQuads * 4, EAllowShrinking::No);
+	UVs.SetNumUninitialized(NumQuads * 4, EAllowShrinking::No);
+	Colors.SetNumUninitialized(NumQuads * 4, EAllowShrinking::No);
+}
+
+namespace VoxelMesherFaces
+{
+	/** Everything the meshers need to know about one face direction */
+	struct FFace
+	{
+		/** Axis the face looks along, and which way */
+		int32 Axis;
+		int32 Sign;
+
+		/** Normal written to the face's vertices */
+		int8 Normal[3];
+
+		/** Corner offsets from the box centre in half extents, in winding order */
+		int8 Corners[4][3];
+
+		/** Axes spanned by the first and second edge of the quad, used to tile UVs */
+		int32 UAxis;
+		int32 VAxis;
+	};
+
+	/** Face directions in emission order */
+	constexpr FFace Faces[6] = {
+		{ 2, 1, { 0, 0, 1 }, { { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } }, 0, 1 },
+		{ 2, -1, { 0, 0, -1 }, { { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 }, { -1, -1, -1 } }, 0, 1 },
+		{ 1, 1, { 1, 0, 0 }, { { -1, 1, -1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 } }, 2, 0 },
+		{ 1, -1, { -1, 0, 0 }, { { 1, -1, -1 }, { 1, -1, 1 }, { -1, -1, 1 }, { -1, -1, -1 } }, 2, 0 },
+		{ 0, 1, { 0, 1, 0 }, { { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 }, { 1, -1, 1 } }, 1, 2 },
+		{ 0, -1, { 0, -1, 0 }, { { -1, 1, -1 }, { -1, -1, -1 }, { -1, -1, 1 }, { -1, 1, 1 } }, 1, 2 }
+	};
+
+	/** Padded-plane index offset of one step along each axis */
+	constexpr int32 AxisStrides[3] = { 1, FVoxelMeshInput::StrideY, FVoxelMeshInput::StrideZ };
+
+	/** Vertex color per EVoxelType; water is semi-transparent */
+	const FColor TypeColors[] = {
+		FColor(255, 255, 255),		// Air
+		FColor(128, 128, 128),		// Stone
+		FColor(139, 69, 19),		// Dirt
+		FColor(34, 139, 34),		// Grass
+		FColor(160, 82, 45),		// Wood
+		FColor(192, 192, 192),		// Iron
+		FColor(255, 215, 0),		// Gold
+		FColor(51, 102, 204, 153),	// Water
+		FColor(25, 76, 230, 179),	// WaterSource, slightly darker
+		FColor(255, 255, 255)		// Custom
+	};
+	static_assert(UE_ARRAY_COUNT(TypeColors) == (int32)EVoxelType::Custom + 1, "Every voxel type needs a color");
+}
+
+struct FVoxelMesher::FQuad
+{
+	FVector Center;
+	FVector HalfExtent;
+	int32 Face;
+	EVoxelType Type;
+};
+
+struct FVoxelMesher::FScratch
+{
+	/** Quads of the section being built */
+	TArray<FQuad> Quads;
+
+	/** Greedy slice mask */
+	TArray<uint16> FaceMask;
+
+	/** Cells already covered by a collision box, or reached by the connectivity flood fill */
+	TArray<bool> Covered;
+
+	/** Flood fill frontier */
+	TArray<int32> Frontier;
+
+	/** Buffers handed out by GetThreadScratchBuffers */
+	FVoxelMeshBuffers Buffers;
+};
+
+FVoxelMesher::FScratch& FVoxelMesher::GetScratch()
+{
+	static thread_local FScratch Scratch;
+	return Scratch;
+}
+
+FVoxelMeshBuffers& FVoxelMesher::GetThreadScratchBuffers()
+{
+	return GetScratch().Buffers;
+}
+
+uint16 FVoxelMesher::ComputeFaceConnectivity(const FVoxelMeshInput& Input)
+{
+	if (Input.LodLevel > 0)
+		return VoxelCoordinates::AllFacePairs;
+
+	const int32 Size = FVoxelMeshInput::Size;
+	FScratch& Scratch = GetScratch();
+	TArray<bool>& Visited = Scratch.Covered;
+	Visited.Reset();
+	Visited.SetNumZeroed(Size * Size * Size);
+	TArray<int32>& Frontier = Scratch.Frontier;
+
+	auto IsOpen = [&Input](int32 X, int32 Y, int32 Z)
+	{
+		return IsVoxelTypeTransparent((EVoxelType)Input.Types[FVoxelMeshInput::Index(X, Y, Z)]);
+	};
+
+	uint16 Connectivity = 0;
+	for (int32 Start = 0; Start < Size * Size * Size; Start++)
+	{
+		const FIntVector StartCell(Start % Size, (Start / Size) % Size, Start / (Size * Size));
+		if (Visited[Start] || !IsOpen(StartCell.X, StartCell.Y, StartCell.Z))
+			continue;
+
+		// Collect the faces this transparent region touches
+		uint8 FaceMask = 0;
+		Visited[Start] = true;
+		Frontier.Reset();
+		Frontier.Add(Start);
+		while (Frontier.Num() > 0)
+		{
+			const int32 Cell = Frontier.Pop(EAllowShrinking::No);
+			const FIntVector Local(Cell % Size, (Cell / Size) % Size, Cell / (Size * Size));
+			FaceMask |= VoxelCoordinates::LocalToBorderFaceMask(Local);
+
+			for (const FIntVector& Direction : VoxelCoordinates::FaceDirections)
+			{
+				const FIntVector Next = Local + Direction;
+				if (!FVoxelChunkStorage::IsValidCoordinate(Next.X, Next.Y, Next.Z))
+					continue;
+
+				const int32 NextCell = Next.X + (Next.Y + Next.Z * Size) * Size;
+				if (!Visited[NextCell] && IsOpen(Next.X, Next.Y, Next.Z))
+				{
+					Visited[NextCell] = true;
+					Frontier.Add(NextCell);
+				}
+			}
+		}
+
+		for (int32 FaceA = 0; FaceA < 6; FaceA++)
+		{
+			for (int32 FaceB = FaceA + 1; FaceB < 6; FaceB++)
+			{
+				if ((FaceMask & (1 << FaceA)) && (FaceMask & (1 << FaceB)))
+				{
+					Connectivity |= 1 << VoxelCoordinates::FacePairBit(FaceA, FaceB);
+				}
+			}
+		}
+
+		if (Connectivity == VoxelCoordinates::AllFacePairs)
+			break;
+	}
+
+	return Connectivity;
+}
+
+FColor FVoxelMesher::GetVoxelTypeColor(EVoxelType Type)
+{
+	return (uint8)Type < UE_ARRAY_COUNT(VoxelMesherFaces::TypeColors) ? VoxelMesherFaces::TypeColors[(uint8)Type] : FColor::White;
+}
+
+void FVoxelMesher::BuildMesh(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode, EVoxelMeshLayer Layer, FVoxelMeshBuffers& OutBuffers)
+{
+	BuildMesh(Input, Mode, Layer, 0, Input.GetCellCount(), OutBuffers);
+}
+
+void FVoxelMesher::BuildMesh(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode, EVoxelMeshLayer Layer, int32 MinZ, int32 MaxZ, FVoxelMeshBuffers& OutBuffers)
+{
+	check(MinZ >= 0 && MinZ <= MaxZ && MaxZ <= Input.GetCellCount());
+
+	// Collect quads first so the vertex streams are sized exactly once
+	TArray<FQuad>& Quads = GetScratch().Quads;
+	Quads.Reset();
+	if (Mode == EVoxelMeshingMode::Greedy)
+	{
+		BuildGreedyMesh(Input, Layer, MinZ, MaxZ, Quads);
+	}
+	else
+	{
+		BuildNaiveMesh(Input, Layer, MinZ, MaxZ, Quads);
+	}
+
+	WriteQuads(Quads, OutBuffers);
+}
+
+FORCEINLINE bool FVoxelMesher::IsFaceVisible(const FVoxelMeshInput& Input, EVoxelMeshLayer Layer, int32 Index, int32 NeighborIndex)
+{
+	const EVoxelType CurrentType = (EVoxelType)Input.Types[Index];
+	const bool bInLayer = Layer == EVoxelMeshLayer::Water ? IsVoxelTypeWater(CurrentType) : IsVoxelTypeSolid(CurrentType);
+	if (!bInLayer)
+		return false;
+
+	const EVoxelType NeighborType = (EVoxelType)Input.Types[NeighborIndex];
+	if (!IsVoxelTypeTransparent(NeighborType))
+		return false;
+
+	// Don't render water faces between water blocks of same level
+	return !(IsVoxelTypeWater(CurrentType) && IsVoxelTypeWater(NeighborType)
+		&& Input.WaterLevels[Index] == Input.WaterLevels[NeighborIndex]);
+}
+
+void FVoxelMesher::BuildNaiveMesh(const FVoxelMeshInput& Input, EVoxelMeshLayer Layer, int32 MinZ, int32 MaxZ, TArray<FQuad>& OutQuads)
+{
+	const int32 Size = Input.GetCellCount();
+	const float CellSize = Input.GetCellSize();
+	const FVector HalfExtent(CellSize * 0.5f);
+
+	// Voxel positions are cell centres at full resolution; coarser cells keep the same outer bounds
+	const FVector Origin(HalfExtent.X - VoxelCoordinates::VoxelSize * 0.5f);
+
+	// Generate mesh for each voxel of the layer; the water pass skips all terrain
+	for (int32 Z = MinZ; Z < MaxZ; Z++)
+	{
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const int32 Index = FVoxelMeshInput::Index(X, Y, Z);
+				const EVoxelType Type = (EVoxelType)Input.Types[Index];
+				if (Layer == EVoxelMeshLayer::Water ? !IsVoxelTypeWater(Type) : !IsVoxelTypeSolid(Type))
+					continue;
+
+				const FVector VoxelPosition = Origin + FVector(X, Y, Z) * CellSize;
+
+				// Add each face exposed to a transparent block, in this chunk or across the border
+				for (int32 Face = 0; Face < 6; Face++)
+				{
+					const VoxelMesherFaces::FFace& Direction = VoxelMesherFaces::Faces[Face];
+					const int32 NeighborIndex = Index + Direction.Sign * VoxelMesherFaces::AxisStrides[Direction.Axis];
+					if (IsFaceVisible(Input, Layer, Index, NeighborIndex))
+					{
+						OutQuads.Add({ VoxelPosition, HalfExtent, Face, Type });
+					}
+				}
+			}
+		}
+	}
+}
+
+void FVoxelMesher::BuildGreedyMesh(const FVoxelMeshInput& Input, EVoxelMeshLayer Layer, int32 MinZ, int32 MaxZ, TArray<FQuad>& OutQuads)
+{
+	const int32 Size = Input.GetCellCount();
+	const float CellSize = Input.GetCellSize();
+	const FVector Origin(-VoxelCoordinates::VoxelSize * 0.5f);
+
+	// Visible faces of one slice; 0 means no face, otherwise type | water level << 8
+	TArray<uint16>& Mask = GetScratch().FaceMask;
+	Mask.SetNumUninitialized(Size * Size, EAllowShrinking::No);
+
+	// Cell range per axis; only Z is limited
+	const int32 Lo[3] = { 0, 0, MinZ };
+	const int32 Hi[3] = { Size, Size, MaxZ };
+
+	for (int32 Face = 0; Face < 6; Face++)
+	{
+		const VoxelMesherFaces::FFace& Direction = VoxelMesherFaces::Faces[Face];
+		const int32 AxisD = Direction.Axis;
+		const int32 AxisU = (AxisD + 1) % 3;
+		const int32 AxisV = (AxisD + 2) % 3;
+		const int32 NeighborOffset = Direction.Sign * VoxelMesherFaces::AxisStrides[AxisD];
+
+		for (int32 Slice = Lo[AxisD]; Slice < Hi[AxisD]; Slice++)
+		{
+			// Gather the faces of this slice that look along Direction
+			FIntVector Cell;
+			Cell[AxisD] = Slice;
+			for (int32 V = Lo[AxisV]; V < Hi[AxisV]; V++)
+			{
+				Cell[AxisV] = V;
+				for (int32 U = Lo[AxisU]; U < Hi[AxisU]; U++)
+				{
+					Cell[AxisU] = U;
+					const int32 Index = FVoxelMeshInput::Index(Cell.X, Cell.Y, Cell.Z);
+					Mask[U + V * Size] = IsFaceVisible(Input, Layer, Index, Index + NeighborOffset)
+						? (uint16)(Input.Types[Index] | (Input.WaterLevels[Index] << 8))
+						: 0;
+				}
+			}
+
+			// Merge equal faces into maximal rectangles, growing along U first, then V
+			for (int32 V = Lo[AxisV]; V < Hi[AxisV]; V++)
+			{
+				for (int32 U = Lo[AxisU]; U < Hi[AxisU]; )
+				{
+					const uint16 Key = Mask[U + V * Size];
+					if (Key == 0)
+					{
+						U++;
+						continue;
+					}
+
+					int32 Width = 1;
+					while (U + Width < Hi[AxisU] && Mask[U + Width + V * Size] == Key)
+					{
+						Width++;
+					}
+
+					int32 Height = 1;
+					for (; V + Height < Hi[AxisV]; Height++)
+					{
+						bool bRowMatches = true;
+						for (int32 K = 0; K < Width; K++)
+						{
+							if (Mask[U + K + (V + Height) * Size] != Key)
+							{
+								bRowMatches = false;
+								break;
+							}
+						}
+						if (!bRowMatches)
+							break;
+					}
+
+					for (int32 DV = 0; DV < Height; DV++)
+					{
+						FMemory::Memzero(&Mask[U + (V + DV) * Size], Width * sizeof(uint16));
+					}
+
+					// Box spanned by the merged cells; full-resolution voxel positions are cell centres
+					FVector Min;
+					Min[AxisD] = Slice;
+					Min[AxisU] = U;
+					Min[AxisV] = V;
+
+					FVector Extent;
+					Extent[AxisD] = 1.0;
+					Extent[AxisU] = Width;
+					Extent[AxisV] = Height;
+
+					const FVector Center = Origin + (Min + Extent * 0.5) * CellSize;
+					OutQuads.Add({ Center, Extent * (CellSize * 0.5f), Face, (EVoxelType)(Key & 0xFF) });
+
+					U += Width;
+				}
+			}
+		}
+	}
+}
+
+void FVoxelMesher::BuildCollisionBoxes(const FVoxelMeshInput& Input, TArray<FBox>& OutBoxes)
+{
+	OutBoxes.Reset();
+
+	const int32 Size = Input.GetCellCount();
+	const float CellSize = Input.GetCellSize();
+
+	// Cells already inside an emitted box, in chunk-local linear order
+	TArray<bool>& Covered = GetScratch().Covered;
+	Covered.Reset();
+	Covered.SetNumZeroed(Size * Size * Size);
+
+	auto IsOpen = [&Input, &Covered, Size](int32 X, int32 Y, int32 Z)
+	{
+		return !Covered[X + (Y + Z * Size) * Size] && IsVoxelTypeSolid((EVoxelType)Input.Types[FVoxelMeshInput::Index(X, Y, Z)]);
+	};
+
+	for (int32 Z = 0; Z < Size; Z++)
+	{
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				if (!IsOpen(X, Y, Z))
+					continue;
+
+				// Grow along X, then whole rows along Y, then whole layers along Z
+				int32 SizeX = 1;
+				while (X + SizeX < Size && IsOpen(X + SizeX, Y, Z))
+				{
+					SizeX++;
+				}
+
+				int32 SizeY = 1;
+				for (; Y + SizeY < Size; SizeY++)
+				{
+					bool bRowOpen = true;
+					for (int32 DX = 0; DX < SizeX && bRowOpen; DX++)
+					{
+						bRowOpen = IsOpen(X + DX, Y + SizeY, Z);
+					}
+					if (!bRowOpen)
+						break;
+				}
+
+				int32 SizeZ = 1;
+				for (; Z + SizeZ < Size; SizeZ++)
+				{
+					bool bLayerOpen = true;
+					for (int32 DY = 0; DY < SizeY && bLayerOpen; DY++)
+					{
+						for (int32 DX = 0; DX < SizeX && bLayerOpen; DX++)
+						{
+							bLayerOpen = IsOpen(X + DX, Y + DY, Z + SizeZ);
+						}
+					}
+					if (!bLayerOpen)
+						break;
+				}
+
+				for (int32 DZ = 0; DZ < SizeZ; DZ++)
+				{
+					for (int32 DY = 0; DY < SizeY; DY++)
+					{
+						for (int32 DX = 0; DX < SizeX; DX++)
+						{
+							Covered[(X + DX) + ((Y + DY) + (Z + DZ) * Size) * Size] = true;
+						}
+					}
+				}
+
+				// Voxel positions are cell centres, so the box starts half a voxel before them
+				const FVector Min = FVector(X, Y, Z) * CellSize - FVector(VoxelCoordinates::VoxelSize * 0.5f);
+				const FVector Max = Min + FVector(SizeX, SizeY, SizeZ) * CellSize;
+
+				OutBoxes.Add(FBox(Min, Max));
+			}
+		}
+	}
+}
+
+void FVoxelMesher::WriteQuads(const TArray<FQuad>& Quads, FVoxelMeshBuffers& OutBuffers)
+{
+	OutBuffers.SetNumQuadsUninitialized(Quads.Num());
+
+	FVector* Vertices = OutBuffers.Vertices.GetData();
+	int32* Triangles = OutBuffers.Triangles.GetData();
+	FVector* Normals = OutBuffers.Normals.GetData();
+	FVector2D* UVs = OutBuffers.UVs.GetData();
+	FColor* Colors = OutBuffers.Colors.GetData();
+
+	for (int32 QuadIndex = 0; QuadIndex < Quads.Num(); QuadIndex++)
+	{
+		const FQuad& Quad = Quads[QuadIndex];
+		const VoxelMesherFaces::FFace& Face = VoxelMesherFaces::Faces[Quad.Face];
+		const FVector Normal(Face.Normal[0], Face.Normal[1], Face.Normal[2]);
+		const FColor Color = GetVoxelTypeColor(Quad.Type);
+		const int32 FirstVertex = QuadIndex * 4;
+
+		for (int32 Corner = 0; Corner < 4; Corner++)
+		{
+			const int8* Offset = Face.Corners[Corner];
+			Vertices[FirstVertex + Corner] = Quad.Center + FVector(Offset[0] * Quad.HalfExtent.X, Offset[1] * Quad.HalfExtent.Y, Offset[2] * Quad.HalfExtent.Z);
+			Normals[FirstVertex + Corner] = Normal;
+			Colors[FirstVertex + Corner] = Color;
+		}
+
+		// One texture repeat per voxel so merged quads tile instead of stretching
+		const float U = Quad.HalfExtent[Face.UAxis] * 2.0f / VoxelCoordinates::VoxelSize;
+		const float V = Quad.HalfExtent[Face.VAxis] * 2.0f / VoxelCoordinates::VoxelSize;
+		UVs[FirstVertex] = FVector2D(0, 0);
+		UVs[FirstVertex + 1] = FVector2D(U, 0);
+		UVs[FirstVertex + 2] = FVector2D(U, V);
+		UVs[FirstVertex + 3] = FVector2D(0, V);
+
+		int32* Triangle = Triangles + QuadIndex * 6;
+		Triangle[0] = FirstVertex;
+		Triangle[1] = FirstVertex + 1;
+		Triangle[2] = FirstVertex + 2;
+		Triangle[3] = FirstVertex;
+		Triangle[4] = FirstVertex + 2;
+		Triangle[5] = FirstVertex + 3;
+	}
+}
@@ -0,0 +1,171 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelData.h"
+#include "VoxelChunkStorage.h"
+#include "VoxelCoordinates.h"
+#include "VoxelMesher.generated.h"
+
+/** How chunk faces are turned into quads */
+UENUM(BlueprintType)
+enum class EVoxelMeshingMode : uint8
+{
+	/** One quad per exposed voxel face */
+	Naive UMETA(DisplayName = "Naive"),
+
+	/** Coplanar faces of the same type and water level merged into maximal rectangles */
+	Greedy UMETA(DisplayName = "Greedy")
+};
+
+/** Which voxels a mesh pass turns into faces */
+enum class EVoxelMeshLayer : uint8
+{
+	/** Solid voxels, rendered opaque */
+	Opaque,
+
+	/** Water voxels, rendered translucent without collision */
+	Water
+};
+
+/**
+ * Type and WaterLevel planes of one chunk surrounded by a one-voxel halo
+ * The halo holds the touching layer of each face-adjacent chunk, so border
+ * faces are culled against real neighbour voxels. Halo cells of neighbours
+ * that are not loaded stay air, which keeps the border faces until the
+ * neighbour arrives and the chunk is remeshed.
+ *
+ * At LodLevel L every cell stands for a block of 2^L voxels per axis and only
+ * the first GetCellCount() cells of each axis (plus halo) are used, so the
+ * same indexing serves every level.
+ */
+struct VOXELSURVIVAL_API FVoxelMeshInput
+{
+	/** Edge length of the chunk itself */
+	static constexpr int32 Size = FVoxelChunkStorage::Size;
+
+	/** Edge length including the halo on both sides */
+	static constexpr int32 PaddedSize = Size + 2;
+
+	/** Number of cells in each padded plane */
+	static constexpr int32 NumCells = PaddedSize * PaddedSize * PaddedSize;
+
+	/** Index offsets between neighbouring cells along Y and Z (X is 1) */
+	static constexpr int32 StrideY = PaddedSize;
+	static constexpr int32 StrideZ = PaddedSize * PaddedSize;
+
+	/** Padded plane index of a local chunk coordinate; -1 and Size address the halo */
+	static constexpr int32 Index(int32 X, int32 Y, int32 Z)
+	{
+		return (X + 1) + (Y + 1) * StrideY + (Z + 1) * StrideZ;
+	}
+
+	/** Highest level of detail reduction; cells of 8x8x8 voxels */
+	static constexpr int32 MaxLodLevel = 3;
+
+	/** Downsampling level: 0 is full resolution, each level halves the cells per axis */
+	int32 LodLevel = 0;
+
+	/** Cells per axis at LodLevel, excluding the halo */
+	int32 GetCellCount() const { return Size >> LodLevel; }
+
+	/** Edge length of one cell in world units */
+	float GetCellSize() const { return VoxelCoordinates::VoxelSize * (1 << LodLevel); }
+
+	/** Voxel types, linear X-major order */
+	TArray<uint8> Types;
+
+	/** Water levels, linear X-major order */
+	TArray<uint8> WaterLevels;
+
+	/** Copy a chunk's voxels into the interior, downsampled to InLodLevel, and reset the halo to air */
+	void Init(const FVoxelChunkStorage& Voxels, int32 InLodLevel = 0);
+
+	/** Copy the cell layer of a neighbour chunk that touches this chunk into the halo, downsampled like the interior */
+	void CopyNeighborLayer(const FVoxelChunkStorage& Neighbor, const FIntVector& FaceDirection);
+
+private:
+	/**
+	 * Collapse a block of 2^LodLevel voxels per axis into one cell
+	 * Cells at least half solid become the topmost solid type, so grass stays on top of far hills;
+	 * cells at least half filled with water and terrain become water at the block's highest level.
+	 */
+	void DownsampleBlock(const uint8* ChunkTypes, const uint8* ChunkWaterLevels, const FIntVector& Cell, int32 CellIndex);
+};
+
+/** Vertex streams of a built chunk mesh, ready for UProceduralMeshComponent::CreateMeshSection */
+struct VOXELSURVIVAL_API FVoxelMeshBuffers
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+	TArray<FColor> Colors;
+
+	/** Empty every stream, keeping allocations */
+	void Reset();
+
+	/** Size every stream for NumQuads quads without initializing them, reusing existing allocations */
+	void SetNumQuadsUninitialized(int32 NumQuads);
+
+	bool IsEmpty() const { return Vertices.Num() == 0; }
+};
+
+/**
+ * Builds chunk geometry from a padded mesh input
+ * Has no engine or actor dependencies so it can run wherever the input lives.
+ */
+class VOXELSURVIVAL_API FVoxelMesher
+{
+public:
+	/** Build quads for every face of a Layer voxel exposed to a transparent neighbour */
+	static void BuildMesh(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode, EVoxelMeshLayer Layer, FVoxelMeshBuffers& OutBuffers);
+
+	/** Build quads only for cells with Z in [MinZ, MaxZ), e.g. one mesh section slab */
+	static void BuildMesh(const FVoxelMeshInput& Input, EVoxelMeshingMode Mode, EVoxelMeshLayer Layer, int32 MinZ, int32 MaxZ, FVoxelMeshBuffers& OutBuffers);
+
+	/**
+	 * Cover the chunk's solid cells with greedily merged boxes for simple collision
+	 * Boxes are in chunk space, ready for UVoxelCollisionComponent::SetCollisionBoxes.
+	 */
+	static void BuildCollisionBoxes(const FVoxelMeshInput& Input, TArray<FBox>& OutBoxes);
+
+	/**
+	 * Which pairs of chunk faces are linked through transparent cells, see VoxelCoordinates::FacePairBit
+	 * Flood fills every air or water region and connects all faces it touches. Downsampled inputs can
+	 * close thin tunnels, so below full resolution every pair counts as connected.
+	 */
+	static uint16 ComputeFaceConnectivity(const FVoxelMeshInput& Input);
+
+	/** Vertex color of a voxel type */
+	static FColor GetVoxelTypeColor(EVoxelType Type);
+
+	/**
+	 * Mesh buffers owned by the calling thread, for callers that upload a mesh right after building it
+	 * Keeping them alive across rebuilds means the streams stop allocating once they reach their peak size.
+	 */
+	static FVoxelMeshBuffers& GetThreadScratchBuffers();
+
+private:
+	/** A face box collected by the meshers before any vertex is written */
+	struct FQuad;
+
+	/** Working memory reused by every build on one thread */
+	struct FScratch;
+
+	/** The calling thread's scratch memory */
+	static FScratch& GetScratch();
+
+	/** One quad per exposed face */
+	static void BuildNaiveMesh(const FVoxelMeshInput& Input, EVoxelMeshLayer Layer, int32 MinZ, int32 MaxZ, TArray<FQuad>& OutQuads);
+
+	/** Per axis-aligned slice, merge exposed faces with equal type and water level into rectangles */
+	static void BuildGreedyMesh(const FVoxelMeshInput& Input, EVoxelMeshLayer Layer, int32 MinZ, int32 MaxZ, TArray<FQuad>& OutQuads);
+
+	/** Whether the voxel at Index belongs to Layer and its face towards NeighborIndex is exposed */
+	static bool IsFaceVisible(const FVoxelMeshInput& Input, EVoxelMeshLayer Layer, int32 Index, int32 NeighborIndex);
+
+	/** Write collected quads to the vertex streams, sized once from the quad count */
+	static void WriteQuads(const TArray<FQuad>& Quads, FVoxelMeshBuffers& OutBuffers);
+};
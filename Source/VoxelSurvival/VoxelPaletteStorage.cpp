@@ -0,0 +1,240 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VoxelPaletteStorage.h"
+
+FVoxelPaletteStorage::FVoxelPaletteStorage()
+	: BitsPerIndex(0)
+	, NumVoxels(0)
+{
+	Palette.Add(0);
+	PaletteRefCounts.Add(0);
+}
+
+void FVoxelPaletteStorage::Init(int32 InNumVoxels, uint8 FillValue)
+{
+	NumVoxels = InNumVoxels;
+	BitsPerIndex = 0;
+	PackedIndices.Empty();
+
+	Palette.Reset();
+	Palette.Add(FillValue);
+	PaletteRefCounts.Reset();
+	PaletteRefCounts.Add(NumVoxels);
+}
+
+void FVoxelPaletteStorage::Empty()
+{
+	Init(0);
+	Palette.Shrink();
+	PaletteRefCounts.Shrink();
+}
+
+uint8 FVoxelPaletteStorage::Get(int32 Index) const
+{
+	check(Index >= 0 && Index < NumVoxels);
+
+	if (BitsPerIndex == 0)
+	{
+		return Palette[0];
+	}
+
+	return Palette[ReadPacked(PackedIndices, BitsPerIndex, Index)];
+}
+
+void FVoxelPaletteStorage::Set(int32 Index, uint8 Value)
+{
+	check(Index >= 0 && Index < NumVoxels);
+
+	if (BitsPerIndex == 0)
+	{
+		if (Palette[0] == Value)
+			return;
+
+		// Leaving uniform mode: every voxel references entry 0
+		Repack(1);
+	}
+
+	const int32 OldEntry = ReadPacked(PackedIndices, BitsPerIndex, Index);
+	if (Palette[OldEntry] == Value)
+		return;
+
+	const int32 NewEntry = FindOrAddPaletteEntry(Value);
+	WritePacked(PackedIndices, BitsPerIndex, Index, NewEntry);
+
+	PaletteRefCounts[OldEntry]--;
+	PaletteRefCounts[NewEntry]++;
+
+	if (PaletteRefCounts[NewEntry] == NumVoxels)
+	{
+		CollapseToUniform(NewEntry);
+	}
+}
+
+void FVoxelPaletteStorage::Decode(uint8* OutValues) const
+{
+	if (BitsPerIndex == 0)
+	{
+		FMemory::Memset(OutValues, Palette[0], NumVoxels);
+		return;
+	}
+
+	// Unpack a whole word at a time so the loop streams the index array once
+	const int32 IndicesPerWord = 32 / BitsPerIndex;
+	const uint32 Mask = (1u << BitsPerIndex) - 1;
+	const uint8* PaletteData = Palette.GetData();
+
+	int32 Index = 0;
+	for (int32 WordIndex = 0; WordIndex < PackedIndices.Num(); WordIndex++)
+	{
+		uint32 Word = PackedIndices[WordIndex];
+		const int32 Count = FMath::Min(IndicesPerWord, NumVoxels - Index);
+		for (int32 i = 0; i < Count; i++)
+		{
+			OutValues[Index++] = PaletteData[Word & Mask];
+			Word >>= BitsPerIndex;
+		}
+	}
+}
+
+void FVoxelPaletteStorage::Compact()
+{
+	if (BitsPerIndex == 0)
+		return;
+
+	// Map live entries to their compacted position
+	TArray<int32> Remap;
+	Remap.SetNumUninitialized(Palette.Num());
+
+	TArray<uint8> NewPalette;
+	TArray<int32> NewRefCounts;
+	for (int32 i = 0; i < Palette.Num(); i++)
+	{
+		if (PaletteRefCounts[i] > 0)
+		{
+			Remap[i] = NewPalette.Num();
+			NewPalette.Add(Palette[i]);
+			NewRefCounts.Add(PaletteRefCounts[i]);
+		}
+		else
+		{
+			Remap[i] = INDEX_NONE;
+		}
+	}
+
+	if (NewPalette.Num() == 1)
+	{
+		CollapseToUniform(Remap.IndexOfByPredicate([](int32 Entry) { return Entry == 0; }));
+		return;
+	}
+
+	const int32 NewBits = BitsForPaletteSize(NewPalette.Num());
+	if (NewPalette.Num() == Palette.Num() && NewBits == BitsPerIndex)
+		return;
+
+	TArray<uint32> NewIndices;
+	NewIndices.SetNumZeroed(WordsForBits(NumVoxels, NewBits));
+	for (int32 i = 0; i < NumVoxels; i++)
+	{
+		WritePacked(NewIndices, NewBits, i, Remap[ReadPacked(PackedIndices, BitsPerIndex, i)]);
+	}
+
+	Palette = MoveTemp(NewPalette);
+	PaletteRefCounts = MoveTemp(NewRefCounts);
+	PackedIndices = MoveTemp(NewIndices);
+	BitsPerIndex = NewBits;
+}
+
+SIZE_T FVoxelPaletteStorage::GetAllocatedSize() const
+{
+	return Palette.GetAllocatedSize() + PaletteRefCounts.GetAllocatedSize() + PackedIndices.GetAllocatedSize();
+}
+
+int32 FVoxelPaletteStorage::FindOrAddPaletteEntry(uint8 Value)
+{
+	int32 FreeSlot = INDEX_NONE;
+	for (int32 i = 0; i < Palette.Num(); i++)
+	{
+		if (PaletteRefCounts[i] > 0)
+		{
+			if (Palette[i] == Value)
+				return i;
+		}
+		else if (FreeSlot == INDEX_NONE)
+		{
+			FreeSlot = i;
+		}
+	}
+
+	if (FreeSlot != INDEX_NONE)
+	{
+		Palette[FreeSlot] = Value;
+		return FreeSlot;
+	}
+
+	const int32 NewEntry = Palette.Add(Value);
+	PaletteRefCounts.Add(0);
+
+	const int32 RequiredBits = BitsForPaletteSize(Palette.Num());
+	if (RequiredBits > BitsPerIndex)
+	{
+		Repack(RequiredBits);
+	}
+
+	return NewEntry;
+}
+
+void FVoxelPaletteStorage::Repack(int32 NewBitsPerIndex)
+{
+	TArray<uint32> OldIndices = MoveTemp(PackedIndices);
+	const int32 OldBits = BitsPerIndex;
+
+	BitsPerIndex = NewBitsPerIndex;
+	PackedIndices.SetNumZeroed(WordsForBits(NumVoxels, NewBitsPerIndex));
+
+	// Coming from uniform mode every index is 0, which the zeroed words already encode
+	if (OldBits > 0)
+	{
+		for (int32 i = 0; i < NumVoxels; i++)
+		{
+			WritePacked(PackedIndices, BitsPerIndex, i, ReadPacked(OldIndices, OldBits, i));
+		}
+	}
+}
+
+void FVoxelPaletteStorage::CollapseToUniform(int32 PaletteIndex)
+{
+	const uint8 Value = Palette[PaletteIndex];
+	Init(NumVoxels, Value);
+}
+
+int32 FVoxelPaletteStorage::BitsForPaletteSize(int32 PaletteSize)
+{
+	if (PaletteSize <= 1) return 0;
+	if (PaletteSize <= 2) return 1;
+	if (PaletteSize <= 4) return 2;
+	if (PaletteSize <= 16) return 4;
+	return 8;
+}
+
+int32 FVoxelPaletteStorage::WordsForBits(int32 Count, int32 Bits)
+{
+	const int32 IndicesPerWord = 32 / Bits;
+	return (Count + IndicesPerWord - 1) / IndicesPerWord;
+}
+
+uint32 FVoxelPaletteStorage::ReadPacked(const TArray<uint32>& Words, int32 Bits, int32 Index)
+{
+	const int32 IndicesPerWord = 32 / Bits;
+	const uint32 Mask = (1u << Bits) - 1;
+	const int32 Shift = (Index % IndicesPerWord) * Bits;
+	return (Words[Index / IndicesPerWord] >> Shift) & Mask;
+}
+
+void FVoxelPaletteStorage::WritePacked(TArray<uint32>& Words, int32 Bits, int32 Index, uint32 Value)
+{
+	const int32 IndicesPerWord = 32 / Bits;
+	const uint32 Mask = (1u << Bits) - 1;
+	const int32 Shift = (Index % IndicesPerWord) * Bits;
+	uint32& Word = Words[Index / IndicesPerWord];
+	Word = (Word & ~(Mask << Shift)) | ((Value & Mask) << Shift);
+}
@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Palette-compressed byte plane
+ * Each distinct value is stored once in a palette and every voxel keeps a
+ * bit-packed index into it. Planes holding a single value (all air, all stone)
+ * collapse to one palette entry with no index array at all.
+ */
+class VOXELSURVIVAL_API FVoxelPaletteStorage
+{
+public:
+	FVoxelPaletteStorage();
+
+	/** Reset storage to NumVoxels copies of FillValue */
+	void Init(int32 InNumVoxels, uint8 FillValue = 0);
+
+	/** Release all memory held by the storage */
+	void Empty();
+
+	/** Number of voxels stored */
+	int32 Num() const { return NumVoxels; }
+
+	/** Get value at linear index */
+	uint8 Get(int32 Index) const;
+
+	/** Set value at linear index, growing the palette if needed */
+	void Set(int32 Index, uint8 Value);
+
+	/** Unpack every value into a contiguous byte plane of Num() entries */
+	void Decode(uint8* OutValues) const;
+
+	/** Drop unused palette entries and shrink indices to the smallest bit width */
+	void Compact();
+
+	/** True when every voxel holds the same value */
+	bool IsUniform() const { return BitsPerIndex == 0; }
+
+	/** Value shared by every voxel, only meaningful when IsUniform() */
+	uint8 GetUniformValue() const { return Palette[0]; }
+
+	/** Number of palette entries, including free slots */
+	int32 GetPaletteSize() const { return Palette.Num(); }
+
+	/** Bits used per voxel index (0 when uniform) */
+	int32 GetBitsPerIndex() const { return BitsPerIndex; }
+
+	/** Heap memory used by the storage in bytes */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Find an entry holding Value, reusing free slots and widening indices when the palette grows */
+	int32 FindOrAddPaletteEntry(uint8 Value);
+
+	/** Re-encode all indices with a new bit width */
+	void Repack(int32 NewBitsPerIndex);
+
+	/** Drop the index array and keep only the given palette entry */
+	void CollapseToUniform(int32 PaletteIndex);
+
+	/** Smallest supported bit width able to address PaletteSize entries */
+	static int32 BitsForPaletteSize(int32 PaletteSize);
+
+	/** Number of 32-bit words needed to hold Count indices of the given width */
+	static int32 WordsForBits(int32 Count, int32 Bits);
+
+	static uint32 ReadPacked(const TArray<uint32>& Words, int32 Bits, int32 Index);
+	static void WritePacked(TArray<uint32>& Words, int32 Bits, int32 Index, uint32 Value);
+
+	/** Distinct values */
+	TArray<uint8> Palette;
+
+	/** Number of voxels referencing each palette entry; 0 marks a free slot */
+	TArray<int32> PaletteRefCounts;
+
+	/** Bit-packed palette indices; widths are powers of two so no index straddles a word */
+	TArray<uint32> PackedIndices;
+
+	int32 BitsPerIndex;
+	int32 NumVoxels;
+};
@@ -0,0 +1,204 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VoxelRenderRegion.h"
+#include "VoxelChunk.h"
+#include "VoxelMesher.h"
+
+namespace VoxelRenderRegion
+{
+	/** Append part of an uploaded section to OutBuffers, moved by Offset, with indices rebased onto OutBuffers */
+	void AppendSectionRange(const FProcMeshSection& Section, const FVoxelRenderRegionSpan& Span, const FVector& Offset, FVoxelMeshBuffers& OutBuffers)
+	{
+		const int32 BaseVertex = OutBuffers.Vertices.Num();
+		for (int32 i = Span.FirstVertex; i < Span.FirstVertex + Span.NumVertices; i++)
+		{
+			const FProcMeshVertex& Vertex = Section.ProcVertexBuffer[i];
+			OutBuffers.Vertices.Add(Vertex.Position + Offset);
+			OutBuffers.Normals.Add(Vertex.Normal);
+			OutBuffers.UVs.Add(Vertex.UV0);
+			OutBuffers.Colors.Add(Vertex.Color);
+		}
+
+		for (int32 i = Span.FirstIndex; i < Span.FirstIndex + Span.NumIndices; i++)
+		{
+			OutBuffers.Triangles.Add(BaseVertex + (int32)Section.ProcIndexBuffer[i] - Span.FirstVertex);
+		}
+	}
+}
+
+AVoxelRenderRegion::AVoxelRenderRegion()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	MeshComponent = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("RegionMesh"));
+	RootComponent = MeshComponent;
+
+	// Purely visual; members keep their own collision
+	MeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	MeshComponent->SetCanEverAffectNavigation(false);
+
+	// Every client batches the chunks it has loaded on its own
+	bReplicates = false;
+}
+
+void AVoxelRenderRegion::AddMember(AVoxelChunk* Chunk)
+{
+	if (!Chunk || Members.ContainsByPredicate([Chunk](const FVoxelRenderRegionMember& Member) { return Member.Chunk == Chunk; }))
+		return;
+
+	FVoxelRenderRegionMember& Member = Members.AddDefaulted_GetRef();
+	Member.Chunk = Chunk;
+	Chunk->SetRenderRegion(this);
+	bMembersAdded = true;
+}
+
+void AVoxelRenderRegion::RemoveMember(AVoxelChunk* Chunk)
+{
+	const int32 Index = Members.IndexOfByPredicate([Chunk](const FVoxelRenderRegionMember& Member) { return Member.Chunk == Chunk; });
+	if (Index == INDEX_NONE)
+		return;
+
+	if (Members[Index].bMerged)
+	{
+		RestoreMember(Members[Index]);
+	}
+	Members.RemoveAt(Index);
+
+	Chunk->SetRenderRegion(nullptr);
+	Chunk->SetMergedIntoRegion(false);
+	bMembersRemoved = true;
+}
+
+void AVoxelRenderRegion::RemoveAllMembers()
+{
+	for (const FVoxelRenderRegionMember& Member : Members)
+	{
+		if (IsValid(Member.Chunk))
+		{
+			if (Member.bMerged)
+			{
+				RestoreMember(Member);
+			}
+			Member.Chunk->SetRenderRegion(nullptr);
+			Member.Chunk->SetMergedIntoRegion(false);
+		}
+	}
+
+	Members.Reset();
+	MeshComponent->ClearAllMeshSections();
+	bMembersAdded = false;
+	bMembersRemoved = false;
+	bMembersChanged = false;
+}
+
+void AVoxelRenderRegion::RestoreMember(const FVoxelRenderRegionMember& Member)
+{
+	const FProcMeshSection* Merged = MeshComponent->GetProcMeshSection(0);
+	const FVector Offset = GetActorLocation() - Member.Chunk->GetActorLocation();
+	const uint32 PendingSlabs = Member.Chunk->GetRegionPendingSlabs();
+
+	// Unmerge first, so the uploads below count as the chunk's own slabs again
+	Member.Chunk->SetMergedIntoRegion(false);
+
+	FVoxelMeshBuffers& Buffers = FVoxelMesher::GetThreadScratchBuffers();
+	for (const FVoxelRenderRegionSpan& Span : Member.Spans)
+	{
+		// The chunk already holds a newer mesh of this slab
+		if (PendingSlabs & (1u << Span.Slab))
+			continue;
+
+		Buffers.Reset();
+		if (Merged)
+		{
+			VoxelRenderRegion::AppendSectionRange(*Merged, Span, Offset, Buffers);
+		}
+		Member.Chunk->ApplyMeshSection(Span.Slab, Buffers);
+	}
+}
+
+void AVoxelRenderRegion::Rebuild()
+{
+	// Destroyed members took their geometry with them
+	Members.RemoveAll([](const FVoxelRenderRegionMember& Member) { return !IsValid(Member.Chunk); });
+
+	// Merge on the game thread's scratch buffers; the component keeps its own copy of the section
+	const FProcMeshSection* Current = MeshComponent->GetProcMeshSection(0);
+	FVoxelMeshBuffers& Merged = FVoxelMesher::GetThreadScratchBuffers();
+	Merged.Reset();
+	for (FVoxelRenderRegionMember& Member : Members)
+	{
+		const FVector Offset = Member.Chunk->GetActorLocation() - GetActorLocation();
+		const uint32 PendingSlabs = Member.bMerged ? Member.Chunk->GetRegionPendingSlabs() : 0;
+		TArray<FVoxelRenderRegionSpan> Spans;
+		for (int32 Slab = 0; Slab < AVoxelChunk::NumMeshSlabs; Slab++)
+		{
+			FVoxelRenderRegionSpan& Span = Spans.AddDefaulted_GetRef();
+			Span.Slab = Slab;
+			Span.FirstVertex = Merged.Vertices.Num();
+			Span.FirstIndex = Merged.Triangles.Num();
+
+			// Merged members' geometry only lives in the region's section now; new members and rebuilt slabs are on the chunk
+			if (Member.bMerged && (PendingSlabs & (1u << Slab)) == 0)
+			{
+				if (Current && Member.Spans.IsValidIndex(Slab))
+				{
+					VoxelRenderRegion::AppendSectionRange(*Current, Member.Spans[Slab], FVector::ZeroVector, Merged);
+				}
+			}
+			else if (const FProcMeshSection* Section = Member.Chunk->GetOpaqueSlabSection(Slab))
+			{
+				FVoxelRenderRegionSpan Whole;
+				Whole.NumVertices = Section->ProcVertexBuffer.Num();
+				Whole.NumIndices = Section->ProcIndexBuffer.Num();
+				VoxelRenderRegion::AppendSectionRange(*Section, Whole, Offset, Merged);
+			}
+
+			Span.NumVertices = Merged.Vertices.Num() - Span.FirstVertex;
+			Span.NumIndices = Merged.Triangles.Num() - Span.FirstIndex;
+		}
+		Member.Spans = MoveTemp(Spans);
+	}
+
+	if (Merged.IsEmpty())
+	{
+		MeshComponent->ClearMeshSection(0);
+	}
+	else
+	{
+		TArray<FProcMeshTangent> Tangents;
+		MeshComponent->CreateMeshSection(0, Merged.Vertices, Merged.Triangles, Merged.Normals, Merged.UVs, Merged.Colors, Tangents, false);
+	}
+
+	// Members give up their slabs only once the merged copy exists, so nothing drops out of view
+	for (FVoxelRenderRegionMember& Member : Members)
+	{
+		if (!Member.bMerged || Member.Chunk->GetRegionPendingSlabs() != 0)
+		{
+			Member.bMerged = true;
+			Member.Chunk->SetMergedIntoRegion(true);
+		}
+	}
+
+	bMembersAdded = false;
+	bMembersRemoved = false;
+	bMembersChanged = false;
+	UpdateVisibility();
+}
+
+void AVoxelRenderRegion::UpdateVisibility()
+{
+	bool bAnyVisible = false;
+	for (const FVoxelRenderRegionMember& Member : Members)
+	{
+		if (IsValid(Member.Chunk) && !Member.Chunk->IsCaveCulled())
+		{
+			bAnyVisible = true;
+			break;
+		}
+	}
+
+	if (MeshComponent->IsVisible() != bAnyVisible)
+	{
+		MeshComponent->SetVisibility(bAnyVisible);
+	}
+}
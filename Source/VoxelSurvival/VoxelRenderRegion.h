@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ProceduralMeshComponent.h"
+#include "VoxelRenderRegion.generated.h"
+
+class AVoxelChunk;
+
+/** Where one member slab's geometry sits in a region's merged section */
+struct FVoxelRenderRegionSpan
+{
+	int32 Slab = 0;
+	int32 FirstVertex = 0;
+	int32 NumVertices = 0;
+	int32 FirstIndex = 0;
+	int32 NumIndices = 0;
+};
+
+/** A chunk batched by a render region */
+USTRUCT()
+struct FVoxelRenderRegionMember
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	AVoxelChunk* Chunk = nullptr;
+
+	/** The chunk's slab sections were handed to the region and cleared on the chunk */
+	bool bMerged = false;
+
+	/** The chunk's slab geometry in the merged section, valid while merged; see AVoxelChunk::GetRegionPendingSlabs for slabs rebuilt since */
+	TArray<FVoxelRenderRegionSpan> Spans;
+};
+
+/**
+ * Render batch for an NxN column of settled chunks
+ * The opaque slab sections of every member are merged into one mesh section, so the whole
+ * region costs one primitive and one draw instead of one per chunk section. Merged members
+ * clear their own slab sections, and members without water hide their mesh component
+ * altogether, so neither the geometry nor the primitive exists twice. A member edited by the
+ * player leaves and gets its slabs back from the merged section, and the region is re-merged
+ * from its own copy without meshing anything. Members remeshed for streaming or level of detail
+ * stay, and the next budgeted Rebuild takes their new slabs over. Water and collision stay on the chunks.
+ */
+UCLASS(NotBlueprintable)
+class VOXELSURVIVAL_API AVoxelRenderRegion : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AVoxelRenderRegion();
+
+	/** Region coordinates in the world's region grid */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Voxel")
+	FIntVector RegionCoordinate;
+
+	/** Add a settled chunk; it keeps drawing itself until the next Rebuild */
+	void AddMember(AVoxelChunk* Chunk);
+
+	/** Give a chunk its opaque sections back; the region must Rebuild before it draws next */
+	void RemoveMember(AVoxelChunk* Chunk);
+
+	/** A merged member uploaded new opaque slabs; the region must Rebuild to draw them */
+	void MarkMemberChanged() { bMembersChanged = true; }
+
+	/** Remove every member, e.g. before the region is destroyed */
+	void RemoveAllMembers();
+
+	/** Merge the new members' opaque sections, the merged members' spans and their rebuilt slabs into the region mesh, then clear them on the members */
+	void Rebuild();
+
+	/** True once members were added, removed or rebuilt since the last Rebuild */
+	bool NeedsRebuild() const { return bMembersAdded || bMembersRemoved || bMembersChanged; }
+
+	/** True if a member left since the last Rebuild, so the region still draws geometry that has moved back to the chunk */
+	bool HasRemovedMembers() const { return bMembersRemoved; }
+
+	/** Show the region only while at least one member is not hidden by cave culling */
+	void UpdateVisibility();
+
+	/** Number of member chunks */
+	int32 GetNumMembers() const { return Members.Num(); }
+
+protected:
+	/** Procedural mesh component holding the merged section */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Voxel")
+	UProceduralMeshComponent* MeshComponent;
+
+	/** Chunks merged into the region mesh, or waiting to be */
+	UPROPERTY()
+	TArray<FVoxelRenderRegionMember> Members;
+
+	/** Unmerge a member and upload its slabs back to the chunk from the region's section, except those it rebuilt since */
+	void RestoreMember(const FVoxelRenderRegionMember& Member);
+
+	/** Members joined since the last Rebuild */
+	bool bMembersAdded = false;
+
+	/** Members left since the last Rebuild */
+	bool bMembersRemoved = false;
+
+	/** Merged members uploaded new slabs since the last Rebuild */
+	bool bMembersChanged = false;
+};
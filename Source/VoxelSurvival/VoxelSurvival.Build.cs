@@ -27,6 +27,12 @@ public class VoxelSurvival : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 
+		// Chunk edge length in voxels (16, 32 or 64); see VoxelChunkStorage.h
+		// PublicDefinitions.Add("VOXEL_CHUNK_SIZE=32");
+
+		// Morton (Z-order) chunk voxel layout; compare with voxel.BenchmarkLayouts
+		// PublicDefinitions.Add("VOXEL_CHUNK_MORTON_LAYOUT=1");
+
 		// For modding support
 		DynamicallyLoadedModuleNames.AddRange(new string[] {
 			"OnlineSubsystem"
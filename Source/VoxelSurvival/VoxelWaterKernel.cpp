@@ -0,0 +1,294 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VoxelWaterKernel.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#define VOXEL_WATER_KERNEL_NEON 1
+	#include <arm_neon.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+	#define VOXEL_WATER_KERNEL_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+#ifndef VOXEL_WATER_KERNEL_NEON
+	#define VOXEL_WATER_KERNEL_NEON 0
+#endif
+
+#ifndef VOXEL_WATER_KERNEL_SSE2
+	#define VOXEL_WATER_KERNEL_SSE2 0
+#endif
+
+static_assert(FVoxelWaterPlanes::Size % 16 == 0, "The vector water kernel processes rows in blocks of 16 cells");
+
+uint8 FVoxelWaterPlanes::GetTypeFlags(EVoxelType Type)
+{
+	if (Type == EVoxelType::Air)
+		return AirFlag;
+	if (Type == EVoxelType::WaterSource)
+		return WaterFlag | SourceFlag;
+	if (Type == EVoxelType::Water)
+		return WaterFlag;
+	return SolidFlag;
+}
+
+void FVoxelWaterPlanes::Init(const FVoxelChunkStorage& Voxels, const TArray<int32>& ActiveCells, const FVoxelChunkStorage* Below)
+{
+	// Halo cells stay flagless: never active, never air, so nothing flows into or out of them
+	Flags.Reset();
+	Flags.SetNumZeroed(NumCells);
+	WaterLevels.Reset();
+	WaterLevels.SetNumZeroed(NumCells);
+
+	Voxels.DecodeTypePlane(Types);
+	const uint8* StorageLevels = Voxels.GetWaterLevelPlane();
+	for (int32 Z = 0; Z < Size; Z++)
+	{
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const int32 StorageIndex = FVoxelChunkStorage::Index(X, Y, Z);
+				const int32 PaddedIndex = Index(X, Y, Z);
+				Flags[PaddedIndex] = GetTypeFlags((EVoxelType)Types[StorageIndex]);
+				WaterLevels[PaddedIndex] = StorageLevels ? StorageLevels[StorageIndex] : 0;
+			}
+		}
+	}
+
+	for (int32 StorageIndex : ActiveCells)
+	{
+		const FIntVector Local = FVoxelChunkStorage::Coordinate(StorageIndex);
+		Flags[Index(Local.X, Local.Y, Local.Z)] |= ActiveFlag;
+	}
+
+	// The bottom layer flows down only into air in a loaded chunk
+	for (int32 Y = 0; Y < Size; Y++)
+	{
+		for (int32 X = 0; X < Size; X++)
+		{
+			Flags[Index(X, Y, -1)] = Below ? GetTypeFlags(Below->GetType(FVoxelChunkStorage::Index(X, Y, Size - 1))) : SolidFlag;
+		}
+	}
+}
+
+bool FVoxelWaterKernel::HasVectorKernel()
+{
+	return VOXEL_WATER_KERNEL_NEON || VOXEL_WATER_KERNEL_SSE2;
+}
+
+void FVoxelWaterKernel::Step(const FVoxelWaterPlanes& Planes, TArray<uint8>& OutProposals)
+{
+	if (HasVectorKernel())
+	{
+		StepVector(Planes, OutProposals);
+	}
+	else
+	{
+		StepScalar(Planes, OutProposals);
+	}
+}
+
+FVoxelWaterPlanes& FVoxelWaterKernel::GetThreadPlanes()
+{
+	static thread_local FVoxelWaterPlanes Planes;
+	return Planes;
+}
+
+TArray<uint8>& FVoxelWaterKernel::GetThreadProposals()
+{
+	static thread_local TArray<uint8> Proposals;
+	return Proposals;
+}
+
+void FVoxelWaterKernel::StepScalar(const FVoxelWaterPlanes& Planes, TArray<uint8>& OutProposals)
+{
+	typedef FVoxelWaterPlanes P;
+	constexpr uint8 ActiveWater = P::WaterFlag | P::ActiveFlag;
+	const int32 Offsets[4] = { 1, -1, P::StrideY, -P::StrideY };
+
+	OutProposals.SetNumUninitialized(P::NumCells, EAllowShrinking::No);
+	const uint8* Flags = Planes.Flags.GetData();
+	const uint8* Levels = Planes.WaterLevels.GetData();
+	uint8* Out = OutProposals.GetData();
+
+	for (int32 Z = 0; Z < P::Size; Z++)
+	{
+		for (int32 Y = 0; Y < P::Size; Y++)
+		{
+			for (int32 X = 0; X < P::Size; X++)
+			{
+				const int32 I = P::Index(X, Y, Z);
+				const uint8 F = Flags[I];
+				const uint8 L = Levels[I];
+
+				uint8 Proposal = 0;
+
+				// Active water above air flows down and, unless it is a source, drains one level
+				if ((F & (ActiveWater | P::SourceFlag)) == ActiveWater && (Flags[I - P::StrideZ] & P::AirFlag))
+				{
+					Proposal = FMath::Max<uint8>(L, 1);
+				}
+
+				// Air below active water fills up
+				if ((Flags[I + P::StrideZ] & ActiveWater) == ActiveWater && (F & P::AirFlag))
+				{
+					Proposal = FMath::Max<uint8>(Proposal, 9);
+				}
+
+				// Active water resting on something spreads one level lower into open, lower neighbours
+				const bool bOpen = (F & (P::SolidFlag | P::SourceFlag)) == 0;
+				for (int32 Offset : Offsets)
+				{
+					const int32 N = I + Offset;
+					const uint8 NeighborLevel = Levels[N];
+					const bool bSpreads = (Flags[N] & ActiveWater) == ActiveWater && !(Flags[N - P::StrideZ] & P::AirFlag) && NeighborLevel >= 2;
+					const bool bAccepts = bOpen && (!(F & P::WaterFlag) || L < NeighborLevel - 1);
+					if (bSpreads && bAccepts)
+					{
+						Proposal = FMath::Max(Proposal, NeighborLevel);
+					}
+				}
+
+				Out[I] = Proposal;
+			}
+		}
+	}
+}
+
+#if VOXEL_WATER_KERNEL_SSE2
+
+namespace VoxelWaterKernelSSE
+{
+	FORCEINLINE __m128i Load(const uint8* Ptr)
+	{
+		return _mm_loadu_si128((const __m128i*)Ptr);
+	}
+
+	/** 0xFF in lanes that have every bit of Bits */
+	FORCEINLINE __m128i HasAll(__m128i Flags, __m128i Bits)
+	{
+		return _mm_cmpeq_epi8(_mm_and_si128(Flags, Bits), Bits);
+	}
+
+	/** 0xFF in lanes where A >= B, unsigned */
+	FORCEINLINE __m128i GreaterEqual(__m128i A, __m128i B)
+	{
+		return _mm_cmpeq_epi8(_mm_max_epu8(A, B), A);
+	}
+}
+
+#elif VOXEL_WATER_KERNEL_NEON
+
+namespace VoxelWaterKernelNEON
+{
+	FORCEINLINE uint8x16_t HasAll(uint8x16_t Flags, uint8x16_t Bits)
+	{
+		return vceqq_u8(vandq_u8(Flags, Bits), Bits);
+	}
+
+	FORCEINLINE uint8x16_t HasAny(uint8x16_t Flags, uint8x16_t Bits)
+	{
+		return vtstq_u8(Flags, Bits);
+	}
+}
+
+#endif
+
+void FVoxelWaterKernel::StepVector(const FVoxelWaterPlanes& Planes, TArray<uint8>& OutProposals)
+{
+#if VOXEL_WATER_KERNEL_SSE2 || VOXEL_WATER_KERNEL_NEON
+	typedef FVoxelWaterPlanes P;
+	const int32 Offsets[4] = { 1, -1, P::StrideY, -P::StrideY };
+
+	OutProposals.SetNumUninitialized(P::NumCells, EAllowShrinking::No);
+	const uint8* Flags = Planes.Flags.GetData();
+	const uint8* Levels = Planes.WaterLevels.GetData();
+	uint8* Out = OutProposals.GetData();
+
+#if VOXEL_WATER_KERNEL_SSE2
+	using namespace VoxelWaterKernelSSE;
+	const __m128i ActiveWater = _mm_set1_epi8(P::WaterFlag | P::ActiveFlag);
+	const __m128i Water = _mm_set1_epi8(P::WaterFlag);
+	const __m128i Source = _mm_set1_epi8(P::SourceFlag);
+	const __m128i Air = _mm_set1_epi8(P::AirFlag);
+	const __m128i SolidOrSource = _mm_set1_epi8(P::SolidFlag | P::SourceFlag);
+	const __m128i One = _mm_set1_epi8(1);
+	const __m128i Two = _mm_set1_epi8(2);
+	const __m128i Nine = _mm_set1_epi8(9);
+#else
+	using namespace VoxelWaterKernelNEON;
+	const uint8x16_t ActiveWater = vdupq_n_u8(P::WaterFlag | P::ActiveFlag);
+	const uint8x16_t Water = vdupq_n_u8(P::WaterFlag);
+	const uint8x16_t Source = vdupq_n_u8(P::SourceFlag);
+	const uint8x16_t Air = vdupq_n_u8(P::AirFlag);
+	const uint8x16_t SolidOrSource = vdupq_n_u8(P::SolidFlag | P::SourceFlag);
+	const uint8x16_t One = vdupq_n_u8(1);
+	const uint8x16_t Two = vdupq_n_u8(2);
+	const uint8x16_t Nine = vdupq_n_u8(9);
+#endif
+
+	for (int32 Z = 0; Z < P::Size; Z++)
+	{
+		for (int32 Y = 0; Y < P::Size; Y++)
+		{
+			for (int32 X = 0; X < P::Size; X += 16)
+			{
+				const int32 I = P::Index(X, Y, Z);
+
+				// Same expressions as StepScalar, one lane per cell; masks are 0xFF where true
+#if VOXEL_WATER_KERNEL_SSE2
+				const __m128i F = Load(Flags + I);
+				const __m128i L = Load(Levels + I);
+
+				const __m128i Drains = _mm_andnot_si128(HasAll(F, Source), _mm_and_si128(HasAll(F, ActiveWater), HasAll(Load(Flags + I - P::StrideZ), Air)));
+				__m128i Proposal = _mm_and_si128(Drains, _mm_max_epu8(L, One));
+
+				const __m128i Fills = _mm_and_si128(HasAll(Load(Flags + I + P::StrideZ), ActiveWater), HasAll(F, Air));
+				Proposal = _mm_max_epu8(Proposal, _mm_and_si128(Fills, Nine));
+
+				const __m128i Open = _mm_cmpeq_epi8(_mm_and_si128(F, SolidOrSource), _mm_setzero_si128());
+				const __m128i NotWater = _mm_cmpeq_epi8(_mm_and_si128(F, Water), _mm_setzero_si128());
+				for (int32 Offset : Offsets)
+				{
+					const __m128i NF = Load(Flags + I + Offset);
+					const __m128i NL = Load(Levels + I + Offset);
+
+					const __m128i Spreads = _mm_andnot_si128(HasAll(Load(Flags + I + Offset - P::StrideZ), Air), _mm_and_si128(HasAll(NF, ActiveWater), GreaterEqual(NL, Two)));
+					const __m128i Lower = _mm_andnot_si128(GreaterEqual(L, _mm_subs_epu8(NL, One)), _mm_set1_epi8(-1));
+					const __m128i Accepts = _mm_and_si128(Open, _mm_or_si128(NotWater, Lower));
+					Proposal = _mm_max_epu8(Proposal, _mm_and_si128(_mm_and_si128(Spreads, Accepts), NL));
+				}
+
+				_mm_storeu_si128((__m128i*)(Out + I), Proposal);
+#else
+				const uint8x16_t F = vld1q_u8(Flags + I);
+				const uint8x16_t L = vld1q_u8(Levels + I);
+
+				const uint8x16_t Drains = vbicq_u8(vandq_u8(HasAll(F, ActiveWater), HasAll(vld1q_u8(Flags + I - P::StrideZ), Air)), HasAll(F, Source));
+				uint8x16_t Proposal = vandq_u8(Drains, vmaxq_u8(L, One));
+
+				const uint8x16_t Fills = vandq_u8(HasAll(vld1q_u8(Flags + I + P::StrideZ), ActiveWater), HasAll(F, Air));
+				Proposal = vmaxq_u8(Proposal, vandq_u8(Fills, Nine));
+
+				const uint8x16_t Open = vmvnq_u8(HasAny(F, SolidOrSource));
+				const uint8x16_t NotWater = vmvnq_u8(HasAny(F, Water));
+				for (int32 Offset : Offsets)
+				{
+					const uint8x16_t NF = vld1q_u8(Flags + I + Offset);
+					const uint8x16_t NL = vld1q_u8(Levels + I + Offset);
+
+					const uint8x16_t Spreads = vbicq_u8(vandq_u8(HasAll(NF, ActiveWater), vcgeq_u8(NL, Two)), HasAll(vld1q_u8(Flags + I + Offset - P::StrideZ), Air));
+					const uint8x16_t Lower = vcltq_u8(L, vqsubq_u8(NL, One));
+					const uint8x16_t Accepts = vandq_u8(Open, vorrq_u8(NotWater, Lower));
+					Proposal = vmaxq_u8(Proposal, vandq_u8(vandq_u8(Spreads, Accepts), NL));
+				}
+
+				vst1q_u8(Out + I, Proposal);
+#endif
+			}
+		}
+	}
+#else
+	StepScalar(Planes, OutProposals);
+#endif
+}
@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelData.h"
+#include "VoxelChunkStorage.h"
+
+/**
+ * Per-voxel water flags and levels of one chunk surrounded by a one-voxel halo
+ * Only the layer below the chunk is read from the halo: it decides whether the bottom layer can
+ * flow down. Halo cells are never active, so water in neighbouring chunks never acts here.
+ */
+struct VOXELSURVIVAL_API FVoxelWaterPlanes
+{
+	/** Edge length of the chunk itself */
+	static constexpr int32 Size = FVoxelChunkStorage::Size;
+
+	/** Edge length including the halo on both sides */
+	static constexpr int32 PaddedSize = Size + 2;
+
+	/** Number of cells in each padded plane */
+	static constexpr int32 NumCells = PaddedSize * PaddedSize * PaddedSize;
+
+	/** Index offsets between neighbouring cells along Y and Z (X is 1) */
+	static constexpr int32 StrideY = PaddedSize;
+	static constexpr int32 StrideZ = PaddedSize * PaddedSize;
+
+	/** Padded plane index of a local chunk coordinate; -1 and Size address the halo */
+	static constexpr int32 Index(int32 X, int32 Y, int32 Z)
+	{
+		return (X + 1) + (Y + 1) * StrideY + (Z + 1) * StrideZ;
+	}
+
+	/** Water or water source */
+	static constexpr uint8 WaterFlag = 1 << 0;
+
+	/** Water source, which never drains and is never overwritten */
+	static constexpr uint8 SourceFlag = 1 << 1;
+
+	/** Solid voxel, or a voxel in a chunk that is not loaded */
+	static constexpr uint8 SolidFlag = 1 << 2;
+
+	/** Air */
+	static constexpr uint8 AirFlag = 1 << 3;
+
+	/** Queued for the running step; only active water proposes writes */
+	static constexpr uint8 ActiveFlag = 1 << 4;
+
+	/** Flags of a voxel type, without ActiveFlag */
+	static uint8 GetTypeFlags(EVoxelType Type);
+
+	/** Per-voxel flags */
+	TArray<uint8> Flags;
+
+	/** Per-voxel water levels */
+	TArray<uint8> WaterLevels;
+
+	/**
+	 * Fill the interior from a chunk and the layer below from the chunk underneath
+	 * @param ActiveCells Storage indices of the cells queued for the step
+	 * @param Below Voxels of the chunk underneath, or null if it is not loaded, which counts as solid
+	 */
+	void Init(const FVoxelChunkStorage& Voxels, const TArray<int32>& ActiveCells, const FVoxelChunkStorage* Below);
+
+private:
+	/** Decoded type plane, kept for its allocation */
+	TArray<uint8> Types;
+};
+
+/**
+ * The water rule of AVoxelChunk::ComputeWaterStep evaluated for every cell of a chunk at once
+ * Instead of scattering writes from each active cell, every cell gathers the writes its neighbours
+ * would propose to it and keeps the highest. Rows of water levels and flag masks are processed
+ * sixteen cells per instruction with SSE2 or NEON where the platform has vector intrinsics; the
+ * scalar kernel evaluates the same expressions one cell at a time and is the reference.
+ *
+ * Output cells hold 0 where no write is proposed, else the proposed level plus one. Only the
+ * chunk's interior is written; writes into neighbouring chunks are left to the caller.
+ */
+class VOXELSURVIVAL_API FVoxelWaterKernel
+{
+public:
+	/** True if Step runs the vector kernel on this platform */
+	static bool HasVectorKernel();
+
+	/** Run the vector kernel where available, otherwise the scalar one */
+	static void Step(const FVoxelWaterPlanes& Planes, TArray<uint8>& OutProposals);
+
+	/** One cell at a time */
+	static void StepScalar(const FVoxelWaterPlanes& Planes, TArray<uint8>& OutProposals);
+
+	/** Sixteen cells at a time; falls back to StepScalar without vector intrinsics */
+	static void StepVector(const FVoxelWaterPlanes& Planes, TArray<uint8>& OutProposals);
+
+	/** Planes owned by the calling thread, so mesh and water workers never allocate per step */
+	static FVoxelWaterPlanes& GetThreadPlanes();
+
+	/** Proposal plane owned by the calling thread */
+	static TArray<uint8>& GetThreadProposals();
+};
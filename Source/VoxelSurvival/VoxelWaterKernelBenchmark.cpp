@@ -0,0 +1,100 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "VoxelChunk.h"
+#include "VoxelWaterKernel.h"
+
+/**
+ * Time the cell-by-cell water rule against the scalar and vector water kernels
+ * Run "voxel.BenchmarkWaterKernel [Iterations]" from the console on the target platform. Every
+ * iteration fills a chunk with random air, water, sources and stone and queues a random subset of
+ * cells. Whether the kernels agree with the rule is checked by the VoxelSurvival.Water.Kernel
+ * automation test, not here.
+ */
+namespace VoxelWaterKernelBenchmark
+{
+	EVoxelType RandomType(FRandomStream& Random)
+	{
+		static const EVoxelType Types[] = { EVoxelType::Air, EVoxelType::Air, EVoxelType::Water, EVoxelType::Water, EVoxelType::WaterSource, EVoxelType::Stone };
+		return Types[Random.RandHelper(UE_ARRAY_COUNT(Types))];
+	}
+
+	void FillRandom(FRandomStream& Random, FVoxelChunkStorage& Voxels)
+	{
+		Voxels.Init();
+		for (int32 Index = 0; Index < FVoxelChunkStorage::NumVoxels; Index++)
+		{
+			FVoxelData Voxel(RandomType(Random));
+			Voxel.WaterLevel = (uint8)Random.RandRange(0, 8);
+			Voxels.Set(Index, Voxel);
+		}
+	}
+}
+
+static void RunVoxelWaterKernelBenchmark(const TArray<FString>& Args)
+{
+	using namespace VoxelWaterKernelBenchmark;
+
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+
+	FRandomStream Random(12345);
+	FVoxelChunkStorage Voxels;
+	TArray<int32> ActiveCells;
+	TArray<FVoxelWaterWrite> Writes;
+	FVoxelWaterPlanes Planes;
+	TArray<uint8> Proposals;
+
+	// Neighbouring chunks are not loaded
+	auto ReadOutsideCell = [](const FIntVector& Voxel, EVoxelType& OutType, uint8& OutWaterLevel)
+	{
+		return false;
+	};
+
+	double SparseSeconds = 0.0;
+	double ScalarSeconds = 0.0;
+	double VectorSeconds = 0.0;
+
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		FillRandom(Random, Voxels);
+
+		// Sparse, dense and full queues
+		const int32 ActiveOneIn = 1 + Iteration % 4;
+		ActiveCells.Reset();
+		for (int32 Index = 0; Index < FVoxelChunkStorage::NumVoxels; Index++)
+		{
+			if (Random.RandHelper(ActiveOneIn) == 0)
+			{
+				ActiveCells.Add(Index);
+			}
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		Writes.Reset();
+		AVoxelChunk::ProposeWaterWrites(Voxels, FIntVector::ZeroValue, ActiveCells, ReadOutsideCell, false, Writes);
+		SparseSeconds += FPlatformTime::Seconds() - StartTime;
+
+		Planes.Init(Voxels, ActiveCells, nullptr);
+
+		StartTime = FPlatformTime::Seconds();
+		FVoxelWaterKernel::StepScalar(Planes, Proposals);
+		ScalarSeconds += FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		FVoxelWaterKernel::StepVector(Planes, Proposals);
+		VectorSeconds += FPlatformTime::Seconds() - StartTime;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Voxel water kernel: %d^3 chunk, %d iterations, vector kernel %s, ms per chunk"),
+		FVoxelWaterPlanes::Size, Iterations, FVoxelWaterKernel::HasVectorKernel() ? TEXT("available") : TEXT("unavailable"));
+	UE_LOG(LogTemp, Log, TEXT("  Cell by cell %.4f  scalar %.4f  vector %.4f"),
+		SparseSeconds * 1000.0 / Iterations, ScalarSeconds * 1000.0 / Iterations, VectorSeconds * 1000.0 / Iterations);
+}
+
+static FAutoConsoleCommand VoxelWaterKernelBenchmarkCommand(
+	TEXT("voxel.BenchmarkWaterKernel"),
+	TEXT("Time the cell-by-cell water rule and the scalar and vector water kernels on random chunks. Usage: voxel.BenchmarkWaterKernel [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunVoxelWaterKernelBenchmark)
+);
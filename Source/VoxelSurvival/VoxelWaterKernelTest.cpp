@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "VoxelChunk.h"
+#include "VoxelWaterKernel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VoxelWaterKernelTest
+{
+	/** Random air, water, sources and stone at random levels, sometimes at the extremes of the byte */
+	void FillRandom(FRandomStream& Random, FVoxelChunkStorage& Voxels)
+	{
+		static const EVoxelType Types[] = { EVoxelType::Air, EVoxelType::Air, EVoxelType::Water, EVoxelType::Water, EVoxelType::WaterSource, EVoxelType::Stone };
+
+		Voxels.Init();
+		for (int32 Index = 0; Index < FVoxelChunkStorage::NumVoxels; Index++)
+		{
+			FVoxelData Voxel(Types[Random.RandHelper(UE_ARRAY_COUNT(Types))]);
+			Voxel.WaterLevel = Random.RandHelper(16) == 0 ? (uint8)Random.RandRange(250, 255) : (uint8)Random.RandRange(0, 9);
+			Voxels.Set(Index, Voxel);
+		}
+	}
+
+	/** Index of the first write that differs, or INDEX_NONE if both lists are equal */
+	int32 FindMismatch(const TArray<FVoxelWaterWrite>& A, const TArray<FVoxelWaterWrite>& B)
+	{
+		for (int32 i = 0; i < FMath::Min(A.Num(), B.Num()); i++)
+		{
+			if (A[i].Voxel != B[i].Voxel || A[i].WaterLevel != B[i].WaterLevel)
+				return i;
+		}
+		return A.Num() == B.Num() ? INDEX_NONE : FMath::Min(A.Num(), B.Num());
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxelWaterKernelTest, "VoxelSurvival.Water.Kernel", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * The scalar and vector water kernels must propose exactly the merged writes of the cell-by-cell
+ * rule in AVoxelChunk::ProposeWaterWrites, and the dense step of AVoxelChunk::ComputeWaterStep,
+ * kernel inside plus border cells outside, must match the cell-by-cell step as a whole.
+ */
+bool FVoxelWaterKernelTest::RunTest(const FString& Parameters)
+{
+	using namespace VoxelWaterKernelTest;
+
+	const FIntVector ChunkCoordinate(3, -2, 1);
+	const FIntVector BelowCoordinate = ChunkCoordinate - FIntVector(0, 0, 1);
+
+	FRandomStream Random(12345);
+	FVoxelChunkStorage Voxels;
+	FVoxelChunkStorage BelowVoxels;
+	TArray<int32> ActiveCells;
+	FVoxelWaterPlanes Planes;
+	TArray<uint8> Proposals;
+
+	for (int32 Iteration = 0; Iteration < 64; Iteration++)
+	{
+		FillRandom(Random, Voxels);
+		FillRandom(Random, BelowVoxels);
+
+		// Sparse, dense and full queues, with and without a loaded chunk underneath
+		const int32 ActiveOneIn = 1 + Iteration % 4;
+		ActiveCells.Reset();
+		for (int32 Index = 0; Index < FVoxelChunkStorage::NumVoxels; Index++)
+		{
+			if (Random.RandHelper(ActiveOneIn) == 0)
+			{
+				ActiveCells.Add(Index);
+			}
+		}
+		const FVoxelChunkStorage* Below = Iteration % 2 == 0 ? &BelowVoxels : nullptr;
+
+		// Only the chunk underneath is loaded
+		auto ReadOutsideCell = [Below, &BelowCoordinate](const FIntVector& Voxel, EVoxelType& OutType, uint8& OutWaterLevel)
+		{
+			if (!Below || VoxelCoordinates::VoxelToChunk(Voxel) != BelowCoordinate)
+				return false;
+
+			const FIntVector Local = VoxelCoordinates::VoxelToLocal(Voxel);
+			const int32 Index = FVoxelChunkStorage::Index(Local.X, Local.Y, Local.Z);
+			OutType = Below->GetType(Index);
+			OutWaterLevel = Below->GetWaterLevel(Index);
+			return true;
+		};
+
+		TArray<FVoxelWaterWrite> CellWrites;
+		AVoxelChunk::ProposeWaterWrites(Voxels, ChunkCoordinate, ActiveCells, ReadOutsideCell, false, CellWrites);
+		AVoxelChunk::MergeWaterWrites(CellWrites);
+
+		// The kernels only write inside the chunk
+		TArray<FVoxelWaterWrite> InteriorCellWrites = CellWrites;
+		InteriorCellWrites.RemoveAll([&ChunkCoordinate](const FVoxelWaterWrite& Write)
+		{
+			return VoxelCoordinates::VoxelToChunk(Write.Voxel) != ChunkCoordinate;
+		});
+
+		Planes.Init(Voxels, ActiveCells, Below);
+
+		TArray<FVoxelWaterWrite> ScalarWrites;
+		FVoxelWaterKernel::StepScalar(Planes, Proposals);
+		AVoxelChunk::AppendWaterKernelWrites(ChunkCoordinate, Proposals, ScalarWrites);
+		AVoxelChunk::MergeWaterWrites(ScalarWrites);
+
+		TArray<FVoxelWaterWrite> VectorWrites;
+		FVoxelWaterKernel::StepVector(Planes, Proposals);
+		AVoxelChunk::AppendWaterKernelWrites(ChunkCoordinate, Proposals, VectorWrites);
+		AVoxelChunk::MergeWaterWrites(VectorWrites);
+
+		// Dense step as ComputeWaterStep assembles it
+		TArray<FVoxelWaterWrite> DenseWrites;
+		FVoxelWaterKernel::Step(Planes, Proposals);
+		AVoxelChunk::AppendWaterKernelWrites(ChunkCoordinate, Proposals, DenseWrites);
+		AVoxelChunk::ProposeWaterWrites(Voxels, ChunkCoordinate, ActiveCells, ReadOutsideCell, true, DenseWrites);
+		AVoxelChunk::MergeWaterWrites(DenseWrites);
+
+		const int32 ScalarMismatch = FindMismatch(InteriorCellWrites, ScalarWrites);
+		const int32 VectorMismatch = FindMismatch(InteriorCellWrites, VectorWrites);
+		const int32 DenseMismatch = FindMismatch(CellWrites, DenseWrites);
+		if (ScalarMismatch != INDEX_NONE || VectorMismatch != INDEX_NONE || DenseMismatch != INDEX_NONE)
+		{
+			AddError(FString::Printf(TEXT("Iteration %d: first mismatching write of the scalar kernel %d, vector kernel %d, dense step %d (of %d cell-by-cell writes)"),
+				Iteration, ScalarMismatch, VectorMismatch, DenseMismatch, CellWrites.Num()));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -3,8 +3,23 @@
 #include "VoxelWorld.h"
 #include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Components/PrimitiveComponent.h"
+#include "EngineUtils.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Async/ParallelFor.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
 #include "Math/UnrealMathUtility.h"
 
+static TAutoConsoleVariable<int32> CVarShowAwakeWater(
+	TEXT("voxel.ShowAwakeWater"),
+	0,
+	TEXT("Draw the bounds of chunks whose water is awake, labelled with their queued cell count. 0: off, 1: on"),
+	ECVF_Cheat
+);
+
 AVoxelWorld::AVoxelWorld()
 {
 	PrimaryActorTick.bCanEverTick = true;
@@ -13,40 +28,811 @@ AVoxelWorld::AVoxelWorld()
 	bReplicates = true;
 }
 
-void AVoxelWorld::BeginPlay()
-{
-	Super::BeginPlay();
-	LastPlayerPosition = FVector::ZeroVector;
+void AVoxelWorld::BeginPlay()
+{
+	Super::BeginPlay();
+	LastPlayerPosition = FVector::ZeroVector;
+
+	// Collision sources are picked from tracked candidates instead of scanning every actor
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		TrackCollisionCandidate(*It);
+	}
+	ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &AVoxelWorld::TrackCollisionCandidate));
+
+	// Servers without rendering never build render sections, so there is nothing to share
+	if (MaxMeshCacheEntries > 0 && AVoxelChunk::ShouldBuildRenderMesh())
+	{
+		MeshCache = MakeShared<FVoxelMeshCache, ESPMode::ThreadSafe>(MaxMeshCacheEntries);
+	}
+
+	// Prewarm the chunk pool so the first streaming pass does not spawn every actor
+	const int32 PrewarmCount = FMath::Min(ChunkPoolPrewarmCount, MaxChunkPoolSize);
+	for (int32 i = ChunkPool.Num(); i < PrewarmCount; i++)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+
+		AVoxelChunk* Chunk = GetWorld()->SpawnActor<AVoxelChunk>(AVoxelChunk::StaticClass(), SpawnParams);
+		if (Chunk)
+		{
+			Chunk->ResetChunk();
+			ChunkPool.Add(Chunk);
+		}
+	}
+}
+
+void AVoxelWorld::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	CollisionCandidates.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AVoxelWorld::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Update chunks around player
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
+	if (PlayerPawn)
+	{
+		FVector PlayerPosition = PlayerPawn->GetActorLocation();
+		if (FVector::Distance(PlayerPosition, LastPlayerPosition) > 1000.0f)
+		{
+			UpdateVisibleChunks(PlayerPosition);
+			LastPlayerPosition = PlayerPosition;
+		}
+	}
+
+	CollisionUpdateTimer -= DeltaTime;
+	if (CollisionUpdateTimer <= 0.0f)
+	{
+		UpdateChunkCollision();
+		CollisionUpdateTimer = CollisionUpdateInterval;
+	}
+
+	UpdateWater(DeltaTime);
+	if (CVarShowAwakeWater.GetValueOnGameThread() != 0)
+	{
+		DrawAwakeWaterDebug();
+	}
+	ProcessRemeshQueue();
+
+	// Visibility only matters where something is drawn
+	if (AVoxelChunk::ShouldBuildRenderMesh())
+	{
+		UpdateCaveCulling();
+	}
+	UpdateRenderRegions();
+}
+
+void AVoxelWorld::UpdateRenderRegions()
+{
+	// Servers without rendering draw nothing; switching batching off hands every chunk its sections back
+	if (!bEnableRenderBatching || !AVoxelChunk::ShouldBuildRenderMesh())
+	{
+		for (const auto& Pair : RenderRegions)
+		{
+			if (IsValid(Pair.Value))
+			{
+				Pair.Value->RemoveAllMembers();
+				Pair.Value->Destroy();
+			}
+		}
+		RenderRegions.Reset();
+		return;
+	}
+
+	// A chunk with a job in flight has not uploaded its final mesh yet
+	TSet<const AVoxelChunk*> BuildingChunks;
+	for (const FVoxelMeshJob& Job : MeshJobs)
+	{
+		BuildingChunks.Add(Job.Chunk.Get());
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (const auto& Pair : LoadedChunks)
+	{
+		AVoxelChunk* Chunk = Pair.Value.Chunk;
+		if (!Chunk || Chunk->GetRenderRegion() || Chunk->IsMeshDirty() || BuildingChunks.Contains(Chunk))
+			continue;
+
+		if (Now - Chunk->GetLastOpaqueChangeTime() < RenderBatchSettleTime)
+			continue;
+
+		const FIntVector RegionCoordinate = GetRenderRegionCoordinate(Pair.Key);
+		AVoxelRenderRegion*& Region = RenderRegions.FindOrAdd(RegionCoordinate);
+		if (!IsValid(Region))
+		{
+			Region = SpawnRenderRegion(RegionCoordinate);
+		}
+		if (Region)
+		{
+			Region->AddMember(Chunk);
+		}
+	}
+
+	// A region a live-edited member left still draws that member's old geometry, so it re-merges now;
+	// joins and slabs rebuilt by streaming or level of detail changes wait for the merge budget
+	int32 NumMerges = 0;
+	for (auto It = RenderRegions.CreateIterator(); It; ++It)
+	{
+		AVoxelRenderRegion* Region = It.Value();
+		if (!IsValid(Region))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (Region->GetNumMembers() == 0)
+		{
+			Region->Destroy();
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (Region->HasRemovedMembers() || (Region->NeedsRebuild() && NumMerges < MaxRenderRegionMergesPerFrame))
+		{
+			Region->Rebuild();
+			NumMerges++;
+		}
+		else
+		{
+			Region->UpdateVisibility();
+		}
+	}
+}
+
+FIntVector AVoxelWorld::GetRenderRegionCoordinate(FIntVector ChunkCoordinate) const
+{
+	const int32 Size = FMath::Max(RenderRegionSize, 1);
+	return FIntVector(
+		FMath::FloorToInt((float)ChunkCoordinate.X / Size),
+		FMath::FloorToInt((float)ChunkCoordinate.Y / Size),
+		ChunkCoordinate.Z
+	);
+}
+
+AVoxelRenderRegion* AVoxelWorld::SpawnRenderRegion(FIntVector RegionCoordinate)
+{
+	const int32 Size = FMath::Max(RenderRegionSize, 1);
+	const FIntVector FirstChunk(RegionCoordinate.X * Size, RegionCoordinate.Y * Size, RegionCoordinate.Z);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = this;
+
+	AVoxelRenderRegion* Region = GetWorld()->SpawnActor<AVoxelRenderRegion>(AVoxelRenderRegion::StaticClass(), VoxelCoordinates::ChunkToWorld(FirstChunk), FRotator::ZeroRotator, SpawnParams);
+	if (Region)
+	{
+		Region->RegionCoordinate = RegionCoordinate;
+	}
+	return Region;
+}
+
+int32 AVoxelWorld::GetNumRenderBatchedChunks() const
+{
+	int32 NumChunks = 0;
+	for (const auto& Pair : LoadedChunks)
+	{
+		if (Pair.Value.Chunk && Pair.Value.Chunk->GetRenderRegion())
+		{
+			NumChunks++;
+		}
+	}
+	return NumChunks;
+}
+
+void AVoxelWorld::UpdateWater(float DeltaTime)
+{
+	WaterStepElapsed += DeltaTime;
+
+	// A step starts once the previous one has run every phase; after a hitch the backlog is dropped
+	if (WaterStepPhase >= NumWaterStepPhases)
+	{
+		if (WaterStepElapsed < WaterStepInterval)
+			return;
+
+		WaterStepElapsed -= WaterStepInterval;
+		if (WaterStepElapsed >= WaterStepInterval)
+		{
+			WaterStepElapsed = 0.0f;
+		}
+		BeginWaterStep();
+	}
+
+	// Run the phases due by now; the rest wait for later frames of the same step
+	const int32 NumDue = WaterStepElapsed >= WaterStepInterval
+		? NumWaterStepPhases
+		: FMath::CeilToInt(NumWaterStepPhases * (WaterStepElapsed / WaterStepInterval));
+
+	while (WaterStepPhase < FMath::Min(NumDue, NumWaterStepPhases))
+	{
+		RunWaterStepPhase(WaterStepPhase++);
+	}
+}
+
+void AVoxelWorld::BeginWaterStep()
+{
+	WaterStepQueue.Reset();
+	WaterStepPhase = 0;
+
+	auto GetPhase = [](const FIntVector& Coordinate)
+	{
+		return (Coordinate.X & 1) | ((Coordinate.Y & 1) << 1) | ((Coordinate.Z & 1) << 2);
+	};
+
+	// Chunks that settled, were pooled or unloaded since they woke go back to sleep
+	TArray<FIntVector> Coordinates;
+	for (auto It = AwakeWaterChunks.CreateIterator(); It; ++It)
+	{
+		const FVoxelChunkEntry* Entry = LoadedChunks.Find(*It);
+		if (!Entry || !Entry->Chunk || Entry->Chunk->GetNumActiveWaterCells() == 0)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		Coordinates.Add(*It);
+	}
+
+	// Map order depends on load history; a fixed order keeps runs reproducible
+	Coordinates.Sort([&GetPhase](const FIntVector& A, const FIntVector& B)
+	{
+		const int32 PhaseA = GetPhase(A);
+		const int32 PhaseB = GetPhase(B);
+		if (PhaseA != PhaseB)
+			return PhaseA < PhaseB;
+		return A.Z != B.Z ? A.Z < B.Z : (A.Y != B.Y ? A.Y < B.Y : A.X < B.X);
+	});
+
+	int32 Phase = 0;
+	for (const FIntVector& Coordinate : Coordinates)
+	{
+		while (Phase < GetPhase(Coordinate))
+		{
+			WaterPhaseEnds[Phase++] = WaterStepQueue.Num();
+		}
+		WaterStepQueue.Add(LoadedChunks[Coordinate].Chunk);
+	}
+	while (Phase < NumWaterStepPhases)
+	{
+		WaterPhaseEnds[Phase++] = WaterStepQueue.Num();
+	}
+}
+
+void AVoxelWorld::RunWaterStepPhase(int32 Phase)
+{
+	const int32 Begin = Phase > 0 ? WaterPhaseEnds[Phase - 1] : 0;
+	const int32 End = WaterPhaseEnds[Phase];
+
+	TArray<AVoxelChunk*> Chunks;
+	for (int32 i = Begin; i < End; i++)
+	{
+		AVoxelChunk* Chunk = WaterStepQueue[i].Get();
+		if (Chunk && Chunk->BeginWaterStep())
+		{
+			Chunks.Add(Chunk);
+		}
+	}
+
+	if (Chunks.Num() == 0)
+		return;
+
+	// Nothing writes voxels until every chunk of the phase has proposed its writes
+	if (WaterWriteBuffers.Num() < Chunks.Num())
+	{
+		WaterWriteBuffers.SetNum(Chunks.Num());
+	}
+	ParallelFor(Chunks.Num(), [this, &Chunks](int32 i)
+	{
+		Chunks[i]->ComputeWaterStep(WaterWriteBuffers[i]);
+	});
+
+	WaterWrites.Reset();
+	for (int32 i = 0; i < Chunks.Num(); i++)
+	{
+		WaterWrites.Append(WaterWriteBuffers[i]);
+	}
+	ApplyWaterWrites(WaterWrites);
+}
+
+bool AVoxelWorld::GetWaterCell(FIntVector VoxelCoordinate, EVoxelType& OutType, uint8& OutWaterLevel) const
+{
+	const FVoxelChunkEntry* Entry = LoadedChunks.Find(VoxelCoordinates::VoxelToChunk(VoxelCoordinate));
+	if (!Entry)
+		return false;
+
+	const FIntVector Local = VoxelCoordinates::VoxelToLocal(VoxelCoordinate);
+	const int32 Index = FVoxelChunkStorage::Index(Local.X, Local.Y, Local.Z);
+	const FVoxelChunkStorage& Voxels = GetEntryVoxels(*Entry);
+	OutType = Voxels.GetType(Index);
+	OutWaterLevel = Voxels.GetWaterLevel(Index);
+	return true;
+}
+
+const FVoxelChunkStorage* AVoxelWorld::FindChunkVoxels(FIntVector ChunkCoordinate) const
+{
+	const FVoxelChunkEntry* Entry = LoadedChunks.Find(ChunkCoordinate);
+	return Entry ? &GetEntryVoxels(*Entry) : nullptr;
+}
+
+void AVoxelWorld::ApplyWaterWrites(TArray<FVoxelWaterWrite>& Writes)
+{
+	AVoxelChunk::MergeWaterWrites(Writes);
+
+	// Merged writes are grouped by chunk, so each changed chunk remeshes once
+	for (int32 First = 0; First < Writes.Num(); )
+	{
+		const FIntVector ChunkCoord = VoxelCoordinates::VoxelToChunk(Writes[First].Voxel);
+		int32 Last = First + 1;
+		while (Last < Writes.Num() && VoxelCoordinates::VoxelToChunk(Writes[Last].Voxel) == ChunkCoord)
+		{
+			Last++;
+		}
+
+		// Water gives an all-air chunk visible faces, so it needs an actor to hold and draw it
+		AVoxelChunk* Chunk = LoadedChunks.Contains(ChunkCoord) ? PromoteChunk(ChunkCoord) : nullptr;
+		if (Chunk)
+		{
+			bool bChanged = false;
+			uint8 BorderFaceMask = 0;
+			for (int32 i = First; i < Last; i++)
+			{
+				const FIntVector Local = VoxelCoordinates::VoxelToLocal(Writes[i].Voxel);
+				FVoxelData Voxel(Writes[i].WaterLevel > 0 ? EVoxelType::Water : EVoxelType::Air);
+				Voxel.WaterLevel = Writes[i].WaterLevel;
+
+				// Writes that change nothing must not wake the cells around them, or settled water never sleeps
+				FVoxelData Current;
+				Chunk->GetVoxelData(Local.X, Local.Y, Local.Z, Current);
+				if (Current.Type == Voxel.Type && Current.WaterLevel == Voxel.WaterLevel)
+					continue;
+
+				Chunk->SetVoxelData(Local.X, Local.Y, Local.Z, Voxel);
+				BorderFaceMask |= VoxelCoordinates::LocalToBorderFaceMask(Local);
+				bChanged = true;
+			}
+
+			// Flow only trades air for water, which never changes opaque faces, so only water sections are rebuilt
+			if (bChanged)
+			{
+				Chunk->MarkMeshSectionsDirty(AVoxelChunk::WaterMeshSectionMask);
+			}
+			if (BorderFaceMask != 0)
+			{
+				MarkNeighborMeshesDirty(ChunkCoord, BorderFaceMask, AVoxelChunk::WaterMeshSectionMask);
+			}
+		}
+
+		First = Last;
+	}
+}
+
+int32 AVoxelWorld::GetNumActiveWaterCells() const
+{
+	int32 NumCells = 0;
+	for (const FIntVector& Coordinate : AwakeWaterChunks)
+	{
+		const FVoxelChunkEntry* Entry = LoadedChunks.Find(Coordinate);
+		if (Entry && Entry->Chunk)
+		{
+			NumCells += Entry->Chunk->GetNumActiveWaterCells();
+		}
+	}
+	return NumCells;
+}
+
+void AVoxelWorld::DrawAwakeWaterDebug() const
+{
+	const FVector Extent(VoxelCoordinates::ChunkWorldSize * 0.5f);
+	for (const FIntVector& Coordinate : AwakeWaterChunks)
+	{
+		const FVoxelChunkEntry* Entry = LoadedChunks.Find(Coordinate);
+		if (!Entry || !Entry->Chunk)
+			continue;
+
+		// Voxel positions are cell centres, so the chunk's bounds start half a voxel before its origin
+		const FVector Center = VoxelCoordinates::ChunkToWorld(Coordinate) - FVector(VoxelCoordinates::VoxelSize * 0.5f) + Extent;
+		DrawDebugBox(GetWorld(), Center, Extent, FColor::Cyan, false, -1.0f, 0, 8.0f);
+		DrawDebugString(GetWorld(), Center, FString::Printf(TEXT("%d"), Entry->Chunk->GetNumActiveWaterCells()), nullptr, FColor::Cyan, 0.0f);
+	}
+}
+
+void AVoxelWorld::ActivateWaterAt(FIntVector VoxelCoordinate)
+{
+	const FVoxelChunkEntry* Entry = LoadedChunks.Find(VoxelCoordinates::VoxelToChunk(VoxelCoordinate));
+	if (Entry && Entry->Chunk)
+	{
+		const FIntVector Local = VoxelCoordinates::VoxelToLocal(VoxelCoordinate);
+		Entry->Chunk->ActivateWaterCell(Local.X, Local.Y, Local.Z);
+	}
+}
+
+uint16 AVoxelWorld::GetEntryFaceConnectivity(const FVoxelChunkEntry& Entry) const
+{
+	if (Entry.Chunk)
+		return Entry.Chunk->GetFaceConnectivity();
+
+	return Entry.Voxels.IsEmpty() ? VoxelCoordinates::AllFacePairs : 0;
+}
+
+void AVoxelWorld::UpdateCaveCulling()
+{
+	CaveVisibleChunks.Reset();
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const bool bCull = bEnableCaveCulling && PlayerController && PlayerController->PlayerCameraManager;
+	const FIntVector CameraChunk = bCull ? WorldToChunkCoordinate(PlayerController->PlayerCameraManager->GetCameraLocation()) : FIntVector::ZeroValue;
+
+	// Without a loaded camera chunk there is nothing to walk from, so everything stays visible
+	if (bCull && LoadedChunks.Contains(CameraChunk))
+	{
+		struct FVisit
+		{
+			FIntVector Coordinate;
+			int32 EntryFace;
+			uint8 TraveledFaces;
+		};
+
+		TArray<FVisit> Queue;
+		Queue.Add({ CameraChunk, INDEX_NONE, 0 });
+		CaveVisibleChunks.Add(CameraChunk);
+
+		for (int32 Head = 0; Head < Queue.Num(); Head++)
+		{
+			const FVisit Visit = Queue[Head];
+			const uint16 Connectivity = GetEntryFaceConnectivity(LoadedChunks[Visit.Coordinate]);
+
+			for (int32 Face = 0; Face < 6; Face++)
+			{
+				// Never step back towards the camera, which also rules out leaving through the entry face
+				if (Visit.TraveledFaces & (1 << VoxelCoordinates::OppositeFace(Face)))
+					continue;
+
+				if (Visit.EntryFace != INDEX_NONE && (Connectivity & (1 << VoxelCoordinates::FacePairBit(Visit.EntryFace, Face))) == 0)
+					continue;
+
+				const FIntVector Next = Visit.Coordinate + VoxelCoordinates::FaceDirections[Face];
+				if (CaveVisibleChunks.Contains(Next) || !LoadedChunks.Contains(Next))
+					continue;
+
+				CaveVisibleChunks.Add(Next);
+				Queue.Add({ Next, VoxelCoordinates::OppositeFace(Face), (uint8)(Visit.TraveledFaces | (1 << Face)) });
+			}
+		}
+	}
+
+	const bool bWalked = CaveVisibleChunks.Num() > 0;
+	NumCaveCulledChunks = 0;
+	for (const auto& Pair : LoadedChunks)
+	{
+		if (!Pair.Value.Chunk)
+			continue;
+
+		const bool bCulled = bWalked && !CaveVisibleChunks.Contains(Pair.Key);
+		Pair.Value.Chunk->SetCaveCulled(bCulled);
+		NumCaveCulledChunks += bCulled ? 1 : 0;
+	}
+}
+
+void AVoxelWorld::UpdateChunkCollision()
+{
+	// Anything that can stand on or bounce off terrain: pawns and simulating physics bodies
+	CollisionSources.Reset();
+	CollisionCandidates.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Actor) { return !Actor.IsValid(); });
+	for (const TWeakObjectPtr<AActor>& Candidate : CollisionCandidates)
+	{
+		const AActor* Actor = Candidate.Get();
+		if (Actor->IsA<APawn>())
+		{
+			CollisionSources.Add(Actor->GetActorLocation());
+			continue;
+		}
+
+		// Any body may simulate, not just the root, and drift away from the actor's location
+		Actor->ForEachComponent<UPrimitiveComponent>(false, [this](const UPrimitiveComponent* Primitive)
+		{
+			if (Primitive->Mobility == EComponentMobility::Movable && Primitive->IsSimulatingPhysics())
+			{
+				CollisionSources.Add(Primitive->GetComponentLocation());
+			}
+		});
+	}
+
+	for (const auto& Pair : LoadedChunks)
+	{
+		if (Pair.Value.Chunk)
+		{
+			Pair.Value.Chunk->SetVoxelCollisionEnabled(IsChunkInCollisionRange(Pair.Key));
+		}
+	}
+}
+
+void AVoxelWorld::TrackCollisionCandidate(AActor* Actor)
+{
+	// Deferred spawns broadcast before their construction script adds components, and mobility can
+	// change later, so every actor is tracked and UpdateChunkCollision decides what counts each scan
+	if (!Actor || Actor == this || Actor->IsA<AVoxelChunk>() || Actor->IsA<AVoxelRenderRegion>())
+		return;
+
+	CollisionCandidates.Add(Actor);
+}
+
+bool AVoxelWorld::IsChunkInCollisionRange(FIntVector ChunkCoordinate) const
+{
+	// Voxel positions are cell centres, so the chunk's bounds start half a voxel before its origin
+	const FVector Min = VoxelCoordinates::ChunkToWorld(ChunkCoordinate) - FVector(VoxelCoordinates::VoxelSize * 0.5f);
+	const FBox Bounds(Min, Min + FVector(VoxelCoordinates::ChunkWorldSize));
+
+	const double RadiusSquared = FMath::Square((double)CollisionRadius);
+	for (const FVector& Source : CollisionSources)
+	{
+		if (Bounds.ComputeSquaredDistanceToPoint(Source) <= RadiusSquared)
+			return true;
+	}
+	return false;
+}
+
+float AVoxelWorld::GetMeshCacheHitRate() const
+{
+	const int64 NumHits = GetMeshCacheHits();
+	const int64 NumLookups = NumHits + GetMeshCacheMisses();
+	return NumLookups > 0 ? (float)((double)NumHits / NumLookups) : 0.0f;
+}
+
+void AVoxelWorld::ResetMeshCacheStats()
+{
+	if (MeshCache.IsValid())
+	{
+		MeshCache->ResetStats();
+	}
+}
+
+int32 AVoxelWorld::GetNumCollisionChunks() const
+{
+	int32 NumChunks = 0;
+	for (const auto& Pair : LoadedChunks)
+	{
+		if (Pair.Value.Chunk && Pair.Value.Chunk->IsVoxelCollisionEnabled())
+		{
+			NumChunks++;
+		}
+	}
+	return NumChunks;
+}
+
+void AVoxelWorld::RequestChunkRemesh(AVoxelChunk* Chunk)
+{
+	if (!Chunk)
+		return;
+
+	bool bAlreadyQueued = false;
+	QueuedRemeshChunks.Add(Chunk, &bAlreadyQueued);
+	if (!bAlreadyQueued)
+	{
+		RemeshQueue.Add(Chunk);
+	}
+}
+
+void AVoxelWorld::ProcessRemeshQueue()
+{
+	CompleteMeshJobs(FPlatformTime::Seconds() + RemeshBudgetMs / 1000.0);
+
+	// Drop chunks that were rebuilt, pooled or destroyed since they were queued
+	RemeshQueue.RemoveAll([this](const TWeakObjectPtr<AVoxelChunk>& Chunk)
+	{
+		const bool bDrop = !Chunk.IsValid() || !Chunk->IsMeshDirty();
+		if (bDrop)
+		{
+			QueuedRemeshChunks.Remove(Chunk);
+		}
+		return bDrop;
+	});
+
+	if (RemeshQueue.Num() == 0 || MeshJobs.Num() >= MaxMeshJobsInFlight)
+		return;
+
+	TArray<FVector> PlayerLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (PlayerController && PlayerController->GetPawn())
+		{
+			PlayerLocations.Add(PlayerController->GetPawn()->GetActorLocation());
+		}
+	}
+
+	// Player edits first, then chunks closest to any player
+	TArray<TPair<double, AVoxelChunk*>> Ordered;
+	Ordered.Reserve(RemeshQueue.Num());
+	for (const TWeakObjectPtr<AVoxelChunk>& Chunk : RemeshQueue)
+	{
+		double DistanceSquared = 0.0;
+		if (PlayerLocations.Num() > 0)
+		{
+			DistanceSquared = TNumericLimits<double>::Max();
+			for (const FVector& PlayerLocation : PlayerLocations)
+			{
+				DistanceSquared = FMath::Min(DistanceSquared, FVector::DistSquared(Chunk->GetActorLocation(), PlayerLocation));
+			}
+		}
+
+		const double Priority = Chunk->HasPendingPlayerEdit() ? -1.0 / (1.0 + DistanceSquared) : DistanceSquared;
+		Ordered.Add(TPair<double, AVoxelChunk*>(Priority, Chunk.Get()));
+	}
+	Ordered.Sort([](const TPair<double, AVoxelChunk*>& A, const TPair<double, AVoxelChunk*>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	// Snapshot each chunk on the game thread and mesh it on a worker
+	int32 NumStarted = 0;
+	while (NumStarted < Ordered.Num() && MeshJobs.Num() < MaxMeshJobsInFlight)
+	{
+		AVoxelChunk* Chunk = Ordered[NumStarted].Value;
+		NumStarted++;
+		QueuedRemeshChunks.Remove(Chunk);
+
+		FVoxelMeshJob& Job = MeshJobs.AddDefaulted_GetRef();
+		Job.Chunk = Chunk;
+
+		// Collision-only jobs, e.g. on servers without rendering, skip the neighbour halo and level of detail
+		const uint32 SectionMask = Chunk->BeginMeshRebuild();
+		FVoxelMeshInput Input;
+		if (SectionMask != 0)
+		{
+			Chunk->GatherMeshInput(Input);
+		}
+		else
+		{
+			Chunk->GatherCollisionInput(Input);
+		}
+		Job.bComputeConnectivity = (SectionMask & AVoxelChunk::AllMeshSlabs) != 0;
+		Job.ConnectivityRevision = Chunk->GetConnectivityRevision();
+		for (int32 Section = 0; Section < AVoxelChunk::NumMeshSections; Section++)
+		{
+			if (SectionMask & (1u << Section))
+			{
+				Job.Sections.Add(Section);
+				Job.SectionRevisions.Add(Chunk->GetMeshSectionRevision(Section));
+			}
+		}
+
+		Job.bBuildCollision = Chunk->IsCollisionDirty();
+		if (Job.bBuildCollision)
+		{
+			Job.CollisionRevision = Chunk->GetCollisionRevision();
+			Chunk->BeginCollisionRebuild();
+		}
+
+		// Chunks drawn at a coarser level still collide with their real voxels
+		FVoxelMeshInput CollisionInput;
+		const bool bSeparateCollisionInput = Job.bBuildCollision && Input.LodLevel > 0;
+		if (bSeparateCollisionInput)
+		{
+			Chunk->GatherCollisionInput(CollisionInput);
+		}
+
+		// Reuse buffers of uploaded jobs so workers rarely allocate vertex streams
+		TArray<FVoxelMeshBuffers> SectionBuffers;
+		SectionBuffers.SetNum(Job.Sections.Num());
+		for (FVoxelMeshBuffers& Buffers : SectionBuffers)
+		{
+			if (SpareMeshBuffers.Num() == 0)
+				break;
+			Buffers = SpareMeshBuffers.Pop(EAllowShrinking::No);
+		}
+
+		Job.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Input = MoveTemp(Input), CollisionInput = MoveTemp(CollisionInput), bSeparateCollisionInput, Sections = Job.Sections, Mode = MeshingMode, bBuildCollision = Job.bBuildCollision, bComputeConnectivity = Job.bComputeConnectivity, SectionBuffers = MoveTemp(SectionBuffers), MeshCache = MeshCache]() mutable
+		{
+			FVoxelMeshJobResult Result;
+			Result.SectionBuffers = MoveTemp(SectionBuffers);
+			Result.CachedSections.SetNum(Sections.Num());
+
+			// Chunks with identical voxels and halo share sections; only misses are meshed, and are moved into the cache
+			const FVoxelMeshCache::FInputDigest Digest = MeshCache.IsValid() ? FVoxelMeshCache::DigestInput(Input, Mode) : FVoxelMeshCache::FInputDigest();
+			for (int32 i = 0; i < Sections.Num(); i++)
+			{
+				if (MeshCache.IsValid())
+				{
+					Result.CachedSections[i] = MeshCache->Find(Digest, Sections[i]);
+					if (Result.CachedSections[i].IsValid())
+						continue;
+				}
+
+				AVoxelChunk::BuildMeshSection(Input, Mode, Sections[i], Result.SectionBuffers[i]);
+				if (MeshCache.IsValid())
+				{
+					Result.CachedSections[i] = MeshCache->Add(Digest, Sections[i], MoveTemp(Result.SectionBuffers[i]));
+				}
+			}
+			if (bBuildCollision)
+			{
+				FVoxelMesher::BuildCollisionBoxes(bSeparateCollisionInput ? CollisionInput : Input, Result.CollisionBoxes);
+			}
+			if (bComputeConnectivity)
+			{
+				Result.FaceConnectivity = FVoxelMesher::ComputeFaceConnectivity(Input);
+			}
+			return Result;
+		});
+	}
+
+	RemeshQueue.Reset();
+	for (int32 i = NumStarted; i < Ordered.Num(); i++)
+	{
+		RemeshQueue.Add(Ordered[i].Value);
+	}
 }
 
-void AVoxelWorld::Tick(float DeltaTime)
+void AVoxelWorld::CompleteMeshJobs(double Deadline)
 {
-	Super::Tick(DeltaTime);
-
-	// Update chunks around player
-	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
-	if (PlayerPawn)
+	// Upload in start order; always upload at least one finished mesh so results never pile up
+	bool bUploaded = false;
+	for (int32 i = 0; i < MeshJobs.Num(); )
 	{
-		FVector PlayerPosition = PlayerPawn->GetActorLocation();
-		if (FVector::Distance(PlayerPosition, LastPlayerPosition) > 1000.0f)
+		FVoxelMeshJob& Job = MeshJobs[i];
+		if (!Job.Task.IsCompleted())
 		{
-			UpdateVisibleChunks(PlayerPosition);
-			LastPlayerPosition = PlayerPosition;
+			i++;
+			continue;
+		}
+
+		AVoxelChunk* Chunk = Job.Chunk.Get();
+		if (Chunk)
+		{
+			if (bUploaded && FPlatformTime::Seconds() >= Deadline)
+				break;
+
+			// Sections edited again after the snapshot, or of a chunk pooled meanwhile, are stale
+			const FVoxelMeshJobResult& Result = Job.Task.GetResult();
+			for (int32 k = 0; k < Job.Sections.Num(); k++)
+			{
+				if (Chunk->GetMeshSectionRevision(Job.Sections[k]) == Job.SectionRevisions[k])
+				{
+					const FVoxelMeshCache::FSharedBuffers& Cached = Result.CachedSections[k];
+					Chunk->ApplyMeshSection(Job.Sections[k], Cached.IsValid() ? *Cached : Result.SectionBuffers[k]);
+					bUploaded = true;
+				}
+			}
+
+			if (Job.bComputeConnectivity && Chunk->GetConnectivityRevision() == Job.ConnectivityRevision)
+			{
+				Chunk->SetFaceConnectivity(Result.FaceConnectivity);
+			}
+
+			// Boxes need no cooking and live on their own component, so handing them over stays cheap
+			if (Job.bBuildCollision && Chunk->IsVoxelCollisionEnabled() && Chunk->GetCollisionRevision() == Job.CollisionRevision)
+			{
+				Chunk->ApplyCollisionBoxes(Result.CollisionBoxes);
+				bUploaded = true;
+			}
 		}
+
+		RecycleMeshBuffers(Job.Task.GetResult());
+		MeshJobs.RemoveAt(i);
 	}
 }
 
-FIntVector AVoxelWorld::WorldToChunkCoordinate(FVector WorldPosition) const
+void AVoxelWorld::RecycleMeshBuffers(FVoxelMeshJobResult& Result)
 {
-	int32 ChunkSize = 16;
-	float VoxelSize = 100.0f;
-	float ChunkWorldSize = ChunkSize * VoxelSize;
+	// Enough for every section of every job in flight; beyond that, let allocations go
+	const int32 MaxSpareBuffers = MaxMeshJobsInFlight * AVoxelChunk::NumMeshSections;
+	for (FVoxelMeshBuffers& Buffers : Result.SectionBuffers)
+	{
+		if (SpareMeshBuffers.Num() >= MaxSpareBuffers)
+			break;
+		SpareMeshBuffers.Add(MoveTemp(Buffers));
+	}
+}
 
-	return FIntVector(
-		FMath::FloorToInt(WorldPosition.X / ChunkWorldSize),
-		FMath::FloorToInt(WorldPosition.Y / ChunkWorldSize),
-		FMath::FloorToInt(WorldPosition.Z / ChunkWorldSize)
-	);
+FIntVector AVoxelWorld::WorldToChunkCoordinate(FVector WorldPosition) const
+{
+	return VoxelCoordinates::WorldToChunk(WorldPosition);
 }
 
 float AVoxelWorld::PerlinNoise(float X, float Y, float Z)
@@ -59,13 +845,11 @@ float AVoxelWorld::PerlinNoise(float X, float Y, float Z)
 	return FMath::Clamp((Noise + 1.0f) * 0.5f, 0.0f, 1.0f);
 }
 
-void AVoxelWorld::GenerateChunkTerrain(AVoxelChunk* Chunk)
+void AVoxelWorld::GenerateChunkTerrain(FIntVector ChunkCoordinate, FVoxelChunkStorage& Voxels)
 {
-	if (!Chunk)
-		return;
-
-	int32 ChunkSize = Chunk->ChunkSize;
-	FIntVector ChunkCoord = Chunk->ChunkCoordinate;
+	const int32 ChunkSize = VoxelCoordinates::ChunkSize;
+	const float VoxelSize = VoxelCoordinates::VoxelSize;
+	FIntVector ChunkCoord = ChunkCoordinate;
 	
 	for (int32 Z = 0; Z < ChunkSize; Z++)
 	{
@@ -75,14 +859,14 @@ void AVoxelWorld::GenerateChunkTerrain(AVoxelChunk* Chunk)
 			{
 				// World position
 				FVector WorldPos = FVector(
-					(ChunkCoord.X * ChunkSize + X) * Chunk->VoxelSize,
-					(ChunkCoord.Y * ChunkSize + Y) * Chunk->VoxelSize,
-					(ChunkCoord.Z * ChunkSize + Z) * Chunk->VoxelSize
+					(ChunkCoord.X * ChunkSize + X) * VoxelSize,
+					(ChunkCoord.Y * ChunkSize + Y) * VoxelSize,
+					(ChunkCoord.Z * ChunkSize + Z) * VoxelSize
 				);
 
 				// Generate height using noise
 				float Height = PerlinNoise(WorldPos.X, WorldPos.Y, 0) * HeightScale;
-				float WorldHeight = WorldPos.Z / Chunk->VoxelSize;
+				float WorldHeight = WorldPos.Z / VoxelSize;
 
 				EVoxelType VoxelType = EVoxelType::Air;
 
@@ -102,54 +886,258 @@ void AVoxelWorld::GenerateChunkTerrain(AVoxelChunk* Chunk)
 					}
 				}
 
-				Chunk->SetVoxel(X, Y, Z, VoxelType);
+				Voxels.SetType(FVoxelChunkStorage::Index(X, Y, Z), VoxelType);
 			}
 		}
 	}
 
-	Chunk->GenerateMesh();
+	// Collapse uniform chunks and shrink the palette now that generation is done
+	Voxels.Compact();
 }
 
-AVoxelChunk* AVoxelWorld::GetOrCreateChunk(FIntVector ChunkCoordinate)
+const FVoxelChunkStorage& AVoxelWorld::GetEntryVoxels(const FVoxelChunkEntry& Entry) const
+{
+	return Entry.Chunk ? Entry.Chunk->GetVoxelStorage() : Entry.Voxels;
+}
+
+bool AVoxelWorld::IsChunkFaceSolid(const FVoxelChunkStorage& Voxels, const FIntVector& FaceDirection) const
+{
+	if (Voxels.IsTypeUniform())
+	{
+		return IsVoxelTypeSolid(Voxels.GetUniformType());
+	}
+
+	const int32 ChunkSize = VoxelCoordinates::ChunkSize;
+	for (int32 A = 0; A < ChunkSize; A++)
+	{
+		for (int32 B = 0; B < ChunkSize; B++)
+		{
+			// Pin the face axis to the layer facing FaceDirection, sweep the other two
+			int32 X = FaceDirection.X != 0 ? (FaceDirection.X > 0 ? ChunkSize - 1 : 0) : A;
+			int32 Y = FaceDirection.Y != 0 ? (FaceDirection.Y > 0 ? ChunkSize - 1 : 0) : (FaceDirection.X != 0 ? A : B);
+			int32 Z = FaceDirection.Z != 0 ? (FaceDirection.Z > 0 ? ChunkSize - 1 : 0) : B;
+
+			if (!IsVoxelTypeSolid(Voxels.GetType(FVoxelChunkStorage::Index(X, Y, Z))))
+				return false;
+		}
+	}
+	return true;
+}
+
+bool AVoxelWorld::ChunkNeedsActor(FIntVector ChunkCoordinate, const FVoxelChunkStorage& Voxels) const
+{
+	if (Voxels.IsEmpty())
+		return false;
+
+	if (!Voxels.IsFullySolid())
+		return true;
+
+	// A solid chunk is only visible through a neighbour face that is not fully solid.
+	// Unloaded neighbours are assumed to occlude until they load.
+	for (const FIntVector& Direction : VoxelCoordinates::FaceDirections)
+	{
+		const FVoxelChunkEntry* Neighbor = LoadedChunks.Find(ChunkCoordinate + Direction);
+		if (Neighbor && !IsChunkFaceSolid(GetEntryVoxels(*Neighbor), Direction * -1))
+			return true;
+	}
+	return false;
+}
+
+void AVoxelWorld::EnsureChunkLoaded(FIntVector ChunkCoordinate)
 {
-	// Check if chunk already exists
 	if (LoadedChunks.Contains(ChunkCoordinate))
+		return;
+
+	FVoxelChunkEntry& Entry = LoadedChunks.Add(ChunkCoordinate);
+	Entry.Voxels.Init(FVoxelData(EVoxelType::Air));
+
+	// Generate terrain
+	GenerateChunkTerrain(ChunkCoordinate, Entry.Voxels);
+
+	if (ChunkNeedsActor(ChunkCoordinate, Entry.Voxels))
+	{
+		PromoteChunk(ChunkCoordinate);
+	}
+
+	// The new chunk may expose solid neighbours that were waiting for it
+	RefreshNeighborPromotion(ChunkCoordinate);
+
+	// Neighbours meshed before this chunk arrived kept their border faces; cull them now
+	MarkNeighborMeshesDirty(ChunkCoordinate, 0x3F);
+
+	// Water resting against the unloaded chunk treated it as solid; wake it to flow in
+	for (int32 Face = 0; Face < 6; Face++)
+	{
+		const FVoxelChunkEntry* Neighbor = LoadedChunks.Find(ChunkCoordinate + VoxelCoordinates::FaceDirections[Face]);
+		if (Neighbor && Neighbor->Chunk)
+		{
+			Neighbor->Chunk->ActivateWaterFacing(VoxelCoordinates::OppositeFace(Face));
+		}
+	}
+}
+
+AVoxelChunk* AVoxelWorld::AcquireChunkActor()
+{
+	while (ChunkPool.Num() > 0)
 	{
-		return LoadedChunks[ChunkCoordinate];
+		AVoxelChunk* Chunk = ChunkPool.Pop();
+		if (IsValid(Chunk))
+		{
+			return Chunk;
+		}
 	}
 
-	// Create new chunk
 	FActorSpawnParameters SpawnParams;
 	SpawnParams.Owner = this;
 	
-	AVoxelChunk* NewChunk = GetWorld()->SpawnActor<AVoxelChunk>(AVoxelChunk::StaticClass(), SpawnParams);
+	return GetWorld()->SpawnActor<AVoxelChunk>(AVoxelChunk::StaticClass(), SpawnParams);
+}
+
+void AVoxelWorld::ReleaseChunkActor(AVoxelChunk* Chunk)
+{
+	if (!IsValid(Chunk))
+		return;
+
+	if (ChunkPool.Num() < MaxChunkPoolSize)
+	{
+		Chunk->ResetChunk();
+		ChunkPool.Add(Chunk);
+	}
+	else
+	{
+		Chunk->LeaveRenderRegion();
+		Chunk->Destroy();
+	}
+}
+
+AVoxelChunk* AVoxelWorld::PromoteChunk(FIntVector ChunkCoordinate)
+{
+	FVoxelChunkEntry* Entry = LoadedChunks.Find(ChunkCoordinate);
+	if (!Entry)
+		return nullptr;
+
+	if (Entry->Chunk)
+		return Entry->Chunk;
+
+	// Reuse a pooled chunk actor, or spawn a new one
+	AVoxelChunk* NewChunk = AcquireChunkActor();
 	if (NewChunk)
 	{
 		NewChunk->InitializeChunk(ChunkCoordinate);
 		
 		// Set chunk world position
-		float ChunkWorldSize = NewChunk->ChunkSize * NewChunk->VoxelSize;
-		FVector ChunkWorldPosition = FVector(
-			ChunkCoordinate.X * ChunkWorldSize,
-			ChunkCoordinate.Y * ChunkWorldSize,
-			ChunkCoordinate.Z * ChunkWorldSize
-		);
-		NewChunk->SetActorLocation(ChunkWorldPosition);
+		NewChunk->SetActorLocation(VoxelCoordinates::ChunkToWorld(ChunkCoordinate));
 
-		// Generate terrain
-		GenerateChunkTerrain(NewChunk);
+		// Hand over the voxels generated while the chunk was actorless
+		NewChunk->SetVoxelStorage(MoveTemp(Entry->Voxels));
+		Entry->Voxels = FVoxelChunkStorage();
+		NewChunk->SetVoxelCollisionEnabled(IsChunkInCollisionRange(ChunkCoordinate));
+		NewChunk->SetMeshLodLevel(GetChunkLodLevel(ChunkCoordinate, LodCenterChunk));
+		NewChunk->MarkMeshDirty();
 
-		LoadedChunks.Add(ChunkCoordinate, NewChunk);
+		Entry->Chunk = NewChunk;
 	}
 
 	return NewChunk;
 }
 
+void AVoxelWorld::CopyNeighborHalo(FIntVector ChunkCoordinate, FVoxelMeshInput& Input) const
+{
+	for (const FIntVector& Direction : VoxelCoordinates::FaceDirections)
+	{
+		const FIntVector NeighborCoord = ChunkCoordinate + Direction;
+		const FVoxelChunkEntry* Neighbor = LoadedChunks.Find(NeighborCoord);
+		if (Neighbor && GetChunkLodLevel(NeighborCoord, LodCenterChunk) == Input.LodLevel)
+		{
+			Input.CopyNeighborLayer(GetEntryVoxels(*Neighbor), Direction);
+		}
+	}
+}
+
+void AVoxelWorld::MarkNeighborMeshesDirty(FIntVector ChunkCoordinate, uint8 FaceMask, uint32 SectionMask, bool bPlayerEdit)
+{
+	for (int32 Face = 0; Face < 6; Face++)
+	{
+		if ((FaceMask & (1 << Face)) == 0)
+			continue;
+
+		const FVoxelChunkEntry* Neighbor = LoadedChunks.Find(ChunkCoordinate + VoxelCoordinates::FaceDirections[Face]);
+		if (!Neighbor || !Neighbor->Chunk)
+			continue;
+
+		// Side neighbours share our Z slabs; the chunk above only sees its bottom slab and the one below its top slab
+		const FIntVector& Direction = VoxelCoordinates::FaceDirections[Face];
+		uint32 NeighborSections = SectionMask;
+		if (Direction.Z != 0)
+		{
+			const uint32 FacingSlab = Direction.Z > 0 ? 1u : 1u << (AVoxelChunk::NumMeshSlabs - 1);
+			NeighborSections = (SectionMask & AVoxelChunk::WaterMeshSectionMask) | ((SectionMask & AVoxelChunk::AllMeshSlabs) ? FacingSlab : 0u);
+		}
+
+		Neighbor->Chunk->MarkMeshSectionsDirty(NeighborSections, bPlayerEdit);
+	}
+}
+
+int32 AVoxelWorld::GetChunkLodLevel(FIntVector ChunkCoordinate, FIntVector CenterChunk) const
+{
+	// Servers without rendering only build collision, which is always at full resolution
+	if (!AVoxelChunk::ShouldBuildRenderMesh())
+		return 0;
+
+	const float Distance = FVector::Distance(FVector(ChunkCoordinate), FVector(CenterChunk));
+
+	int32 LodLevel = 0;
+	for (int32 Ring = 0; Ring < LodRingDistances.Num() && Ring < FVoxelMeshInput::MaxLodLevel; Ring++)
+	{
+		if (Distance > LodRingDistances[Ring])
+		{
+			LodLevel = Ring + 1;
+		}
+	}
+	return LodLevel;
+}
+
+void AVoxelWorld::RefreshNeighborPromotion(FIntVector ChunkCoordinate)
+{
+	for (const FIntVector& Direction : VoxelCoordinates::FaceDirections)
+	{
+		const FIntVector NeighborCoord = ChunkCoordinate + Direction;
+		FVoxelChunkEntry* Neighbor = LoadedChunks.Find(NeighborCoord);
+		if (Neighbor && !Neighbor->Chunk && ChunkNeedsActor(NeighborCoord, Neighbor->Voxels))
+		{
+			PromoteChunk(NeighborCoord);
+		}
+	}
+}
+
+AVoxelChunk* AVoxelWorld::GetOrCreateChunk(FIntVector ChunkCoordinate)
+{
+	EnsureChunkLoaded(ChunkCoordinate);
+	return PromoteChunk(ChunkCoordinate);
+}
+
+int32 AVoxelWorld::GetNumChunkActors() const
+{
+	int32 NumActors = 0;
+	for (const auto& Pair : LoadedChunks)
+	{
+		if (Pair.Value.Chunk)
+		{
+			NumActors++;
+		}
+	}
+	return NumActors;
+}
+
 void AVoxelWorld::UpdateVisibleChunks(FVector PlayerPosition)
 {
 	FIntVector PlayerChunk = WorldToChunkCoordinate(PlayerPosition);
 
-	// Load chunks in render distance
+	// Recentre the detail rings first so chunks promoted below start at their final level
+	const FIntVector PreviousLodCenter = LodCenterChunk;
+	LodCenterChunk = PlayerChunk;
+
+	// Load chunks in render distance; only chunks with visible geometry get an actor
 	for (int32 Z = -1; Z <= 1; Z++)
 	{
 		for (int32 Y = -RenderDistance; Y <= RenderDistance; Y++)
@@ -157,7 +1145,7 @@ void AVoxelWorld::UpdateVisibleChunks(FVector PlayerPosition)
 			for (int32 X = -RenderDistance; X <= RenderDistance; X++)
 			{
 				FIntVector ChunkCoord = PlayerChunk + FIntVector(X, Y, Z);
-				GetOrCreateChunk(ChunkCoord);
+				EnsureChunkLoaded(ChunkCoord);
 			}
 		}
 	}
@@ -180,51 +1168,252 @@ void AVoxelWorld::UpdateVisibleChunks(FVector PlayerPosition)
 
 	for (FIntVector ChunkCoord : ChunksToRemove)
 	{
-		AVoxelChunk* Chunk = LoadedChunks[ChunkCoord];
-		if (Chunk)
+		// Park the actor for reuse instead of destroying it
+		ReleaseChunkActor(LoadedChunks[ChunkCoord].Chunk);
+		LoadedChunks.Remove(ChunkCoord);
+	}
+
+	// Chunks left bordering the unloaded ones must show their border faces again
+	for (FIntVector ChunkCoord : ChunksToRemove)
+	{
+		MarkNeighborMeshesDirty(ChunkCoord, 0x3F);
+	}
+
+	// Swap levels of detail; neighbours of a chunk that changed level rebuild their halo or skirt against it
+	if (PreviousLodCenter != LodCenterChunk)
+	{
+		for (const auto& Pair : LoadedChunks)
 		{
-			Chunk->Destroy();
+			const int32 LodLevel = GetChunkLodLevel(Pair.Key, LodCenterChunk);
+			if (LodLevel == GetChunkLodLevel(Pair.Key, PreviousLodCenter))
+				continue;
+
+			if (Pair.Value.Chunk)
+			{
+				Pair.Value.Chunk->SetMeshLodLevel(LodLevel);
+			}
+			MarkNeighborMeshesDirty(Pair.Key, 0x3F);
 		}
-		LoadedChunks.Remove(ChunkCoord);
 	}
 }
 
 EVoxelType AVoxelWorld::GetVoxelAtWorldPosition(FVector WorldPosition)
 {
 	FIntVector ChunkCoord = WorldToChunkCoordinate(WorldPosition);
-	AVoxelChunk* Chunk = GetOrCreateChunk(ChunkCoord);
-	
-	if (!Chunk)
-		return EVoxelType::Air;
+	EnsureChunkLoaded(ChunkCoord);
 
-	// Convert to local voxel coordinates
-	float ChunkWorldSize = Chunk->ChunkSize * Chunk->VoxelSize;
-	FVector LocalPos = WorldPosition - Chunk->GetActorLocation();
-	
-	int32 X = FMath::FloorToInt(LocalPos.X / Chunk->VoxelSize);
-	int32 Y = FMath::FloorToInt(LocalPos.Y / Chunk->VoxelSize);
-	int32 Z = FMath::FloorToInt(LocalPos.Z / Chunk->VoxelSize);
+	// Reads never need an actor, so look the voxel up wherever the chunk keeps it
+	const FVoxelChunkStorage& Voxels = GetEntryVoxels(LoadedChunks[ChunkCoord]);
 
-	return Chunk->GetVoxel(X, Y, Z);
+	// Convert to local voxel coordinates
+	const FIntVector Local = VoxelCoordinates::VoxelToLocal(WorldToVoxelCoordinate(WorldPosition));
+	return Voxels.GetType(FVoxelChunkStorage::Index(Local.X, Local.Y, Local.Z));
 }
 
 void AVoxelWorld::SetVoxelAtWorldPosition(FVector WorldPosition, EVoxelType Type)
 {
-	FIntVector ChunkCoord = WorldToChunkCoordinate(WorldPosition);
-	AVoxelChunk* Chunk = GetOrCreateChunk(ChunkCoord);
-	
-	if (!Chunk)
-		return;
+	TArray<TPair<FIntVector, EVoxelType>> Edits;
+	Edits.Add(TPair<FIntVector, EVoxelType>(WorldToVoxelCoordinate(WorldPosition), Type));
+	ApplyVoxelCoordinateEdits(Edits);
+}
 
-	// Convert to local voxel coordinates
-	FVector LocalPos = WorldPosition - Chunk->GetActorLocation();
-	
-	int32 X = FMath::FloorToInt(LocalPos.X / Chunk->VoxelSize);
-	int32 Y = FMath::FloorToInt(LocalPos.Y / Chunk->VoxelSize);
-	int32 Z = FMath::FloorToInt(LocalPos.Z / Chunk->VoxelSize);
+FIntVector AVoxelWorld::WorldToVoxelCoordinate(FVector WorldPosition) const
+{
+	return VoxelCoordinates::WorldToVoxel(WorldPosition);
+}
+
+TArray<FIntVector> AVoxelWorld::ApplyVoxelCoordinateEdits(const TArray<TPair<FIntVector, EVoxelType>>& Edits)
+{
+	// Group writes by chunk so each chunk is looked up and remeshed once
+	TMap<FIntVector, TArray<TPair<FIntVector, EVoxelType>>> EditsByChunk;
+	for (const TPair<FIntVector, EVoxelType>& Edit : Edits)
+	{
+		const FIntVector ChunkCoord = VoxelCoordinates::VoxelToChunk(Edit.Key);
+		const FIntVector LocalCoord = VoxelCoordinates::VoxelToLocal(Edit.Key);
+		EditsByChunk.FindOrAdd(ChunkCoord).Add(TPair<FIntVector, EVoxelType>(LocalCoord, Edit.Value));
+	}
+
+	TArray<FIntVector> ChangedChunks;
+	for (const auto& ChunkEdits : EditsByChunk)
+	{
+		const FIntVector ChunkCoord = ChunkEdits.Key;
+		EnsureChunkLoaded(ChunkCoord);
+
+		// Leave chunks the batch would not change alone, so actorless chunks stay actorless
+		const FVoxelChunkStorage& Voxels = GetEntryVoxels(LoadedChunks[ChunkCoord]);
+		bool bHasChanges = false;
+		for (const TPair<FIntVector, EVoxelType>& Edit : ChunkEdits.Value)
+		{
+			const FIntVector& Local = Edit.Key;
+			if (Voxels.GetType(FVoxelChunkStorage::Index(Local.X, Local.Y, Local.Z)) != Edit.Value)
+			{
+				bHasChanges = true;
+				break;
+			}
+		}
+
+		if (!bHasChanges)
+			continue;
+
+		AVoxelChunk* Chunk = PromoteChunk(ChunkCoord);
+		if (!Chunk)
+			continue;
+
+		// Only the slabs around edited voxels are rebuilt, plus the water section whose faces they may expose
+		uint32 SectionMask = AVoxelChunk::WaterMeshSectionMask;
+		uint8 BorderFaceMask = 0;
+		uint32 BorderSectionMask = AVoxelChunk::WaterMeshSectionMask;
+		for (const TPair<FIntVector, EVoxelType>& Edit : ChunkEdits.Value)
+		{
+			const FIntVector& Local = Edit.Key;
+			Chunk->SetVoxel(Local.X, Local.Y, Local.Z, Edit.Value);
+			SectionMask |= AVoxelChunk::GetMeshSlabsAroundZ(Local.Z);
+
+			if (const uint8 FaceMask = VoxelCoordinates::LocalToBorderFaceMask(Local))
+			{
+				BorderFaceMask |= FaceMask;
+				BorderSectionMask |= 1u << AVoxelChunk::GetMeshSlab(Local.Z);
+			}
+		}
+
+		Chunk->MarkVoxelsChanged(SectionMask, true);
+		ChangedChunks.Add(ChunkCoord);
+
+		// Edits on the chunk border can expose an actorless neighbour and change the halo of loaded ones
+		if (BorderFaceMask != 0)
+		{
+			RefreshNeighborPromotion(ChunkCoord);
+			MarkNeighborMeshesDirty(ChunkCoord, BorderFaceMask, BorderSectionMask, true);
+		}
+	}
+
+	return ChangedChunks;
+}
+
+TArray<FIntVector> AVoxelWorld::ApplyVoxelEdits(const TArray<FVoxelEdit>& Edits)
+{
+	TArray<TPair<FIntVector, EVoxelType>> CoordinateEdits;
+	CoordinateEdits.Reserve(Edits.Num());
+	for (const FVoxelEdit& Edit : Edits)
+	{
+		CoordinateEdits.Add(TPair<FIntVector, EVoxelType>(WorldToVoxelCoordinate(Edit.WorldPosition), Edit.Type));
+	}
+
+	return ApplyVoxelCoordinateEdits(CoordinateEdits);
+}
+
+TArray<FIntVector> AVoxelWorld::SetVoxelsInBox(FVector MinCorner, FVector MaxCorner, EVoxelType Type)
+{
+	const FVector BoxMin = MinCorner.ComponentMin(MaxCorner);
+	const FVector BoxMax = MinCorner.ComponentMax(MaxCorner);
+	const float VoxelSize = VoxelCoordinates::VoxelSize;
+
+	// The max corner is exclusive, so a box ending on a voxel boundary does not take the next layer; a flat box still takes one
+	const FIntVector MinVoxel = WorldToVoxelCoordinate(BoxMin);
+	const FIntVector MaxVoxel(
+		FMath::Max(MinVoxel.X, FMath::CeilToInt(BoxMax.X / VoxelSize) - 1),
+		FMath::Max(MinVoxel.Y, FMath::CeilToInt(BoxMax.Y / VoxelSize) - 1),
+		FMath::Max(MinVoxel.Z, FMath::CeilToInt(BoxMax.Z / VoxelSize) - 1)
+	);
+
+	TArray<TPair<FIntVector, EVoxelType>> Edits;
+	for (int32 Z = MinVoxel.Z; Z <= MaxVoxel.Z; Z++)
+	{
+		for (int32 Y = MinVoxel.Y; Y <= MaxVoxel.Y; Y++)
+		{
+			for (int32 X = MinVoxel.X; X <= MaxVoxel.X; X++)
+			{
+				Edits.Add(TPair<FIntVector, EVoxelType>(FIntVector(X, Y, Z), Type));
+			}
+		}
+	}
+
+	return ApplyVoxelCoordinateEdits(Edits);
+}
+
+TArray<FIntVector> AVoxelWorld::SetVoxelsInSphere(FVector Center, float Radius, EVoxelType Type)
+{
+	const float VoxelSize = VoxelCoordinates::VoxelSize;
+	const FIntVector MinVoxel = WorldToVoxelCoordinate(Center - FVector(Radius));
+	const FIntVector MaxVoxel = WorldToVoxelCoordinate(Center + FVector(Radius));
+	const float RadiusSquared = Radius * Radius;
+
+	TArray<TPair<FIntVector, EVoxelType>> Edits;
+	for (int32 Z = MinVoxel.Z; Z <= MaxVoxel.Z; Z++)
+	{
+		for (int32 Y = MinVoxel.Y; Y <= MaxVoxel.Y; Y++)
+		{
+			for (int32 X = MinVoxel.X; X <= MaxVoxel.X; X++)
+			{
+				FVector VoxelCenter = (FVector(X, Y, Z) + FVector(0.5f)) * VoxelSize;
+				if (FVector::DistSquared(VoxelCenter, Center) <= RadiusSquared)
+				{
+					Edits.Add(TPair<FIntVector, EVoxelType>(FIntVector(X, Y, Z), Type));
+				}
+			}
+		}
+	}
+
+	return ApplyVoxelCoordinateEdits(Edits);
+}
+
+TArray<FIntVector> AVoxelWorld::SetVoxelsAlongLine(FVector Start, FVector End, EVoxelType Type)
+{
+	const float VoxelSize = VoxelCoordinates::VoxelSize;
+	const FVector From = Start / VoxelSize;
+	const FVector Direction = End / VoxelSize - From;
+	const FIntVector Last = WorldToVoxelCoordinate(End);
+
+	// Amanatides-Woo traversal: cross one voxel boundary at a time, always the nearest one along the segment
+	FIntVector Voxel = WorldToVoxelCoordinate(Start);
+	FIntVector Step;
+	FVector NextBoundary;
+	FVector BoundarySpacing;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (Direction[Axis] > 0.0)
+		{
+			Step[Axis] = 1;
+			NextBoundary[Axis] = (Voxel[Axis] + 1 - From[Axis]) / Direction[Axis];
+			BoundarySpacing[Axis] = 1.0 / Direction[Axis];
+		}
+		else if (Direction[Axis] < 0.0)
+		{
+			Step[Axis] = -1;
+			NextBoundary[Axis] = (From[Axis] - Voxel[Axis]) / -Direction[Axis];
+			BoundarySpacing[Axis] = -1.0 / Direction[Axis];
+		}
+		else
+		{
+			Step[Axis] = 0;
+			NextBoundary[Axis] = TNumericLimits<float>::Max();
+			BoundarySpacing[Axis] = TNumericLimits<float>::Max();
+		}
+	}
+
+	// Every crossing moves one axis one voxel closer to the end voxel, so the count is exact
+	const int32 NumCrossings = FMath::Abs(Last.X - Voxel.X) + FMath::Abs(Last.Y - Voxel.Y) + FMath::Abs(Last.Z - Voxel.Z);
+
+	TArray<TPair<FIntVector, EVoxelType>> Edits;
+	Edits.Add(TPair<FIntVector, EVoxelType>(Voxel, Type));
+	for (int32 i = 0; i < NumCrossings; i++)
+	{
+		// Axes that already reached the end voxel are skipped, so rounding near the end can not overshoot it
+		int32 CrossAxis = INDEX_NONE;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			if (Voxel[Axis] != Last[Axis] && (CrossAxis == INDEX_NONE || NextBoundary[Axis] < NextBoundary[CrossAxis]))
+			{
+				CrossAxis = Axis;
+			}
+		}
+
+		Voxel[CrossAxis] += Step[CrossAxis];
+		NextBoundary[CrossAxis] += BoundarySpacing[CrossAxis];
+		Edits.Add(TPair<FIntVector, EVoxelType>(Voxel, Type));
+	}
 
-	Chunk->SetVoxel(X, Y, Z, Type);
-	Chunk->GenerateMesh();
+	return ApplyVoxelCoordinateEdits(Edits);
 }
 
 void AVoxelWorld::SaveWorldData(const FString& SaveName)
@@ -5,8 +5,90 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "VoxelChunk.h"
+#include "VoxelMesher.h"
+#include "VoxelMeshCache.h"
+#include "VoxelRenderRegion.h"
+#include "Tasks/Task.h"
 #include "VoxelWorld.generated.h"
 
+/**
+ * Entry in the world's chunk map
+ * Chunks without visible geometry (all air, or solid and enclosed by solid
+ * neighbours) keep their voxels here and never spawn an actor until they are
+ * exposed or edited.
+ */
+USTRUCT()
+struct FVoxelChunkEntry
+{
+	GENERATED_BODY()
+
+	/** Chunk actor, null while the chunk is actorless */
+	UPROPERTY()
+	AVoxelChunk* Chunk = nullptr;
+
+	/** Voxels of an actorless chunk; moved into the actor on promotion */
+	FVoxelChunkStorage Voxels;
+};
+
+/** A single world-space voxel write for the batched edit API */
+USTRUCT(BlueprintType)
+struct FVoxelEdit
+{
+	GENERATED_BODY()
+
+	/** World position inside the voxel to edit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel Edit")
+	FVector WorldPosition = FVector::ZeroVector;
+
+	/** Voxel type to write */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel Edit")
+	EVoxelType Type = EVoxelType::Air;
+};
+
+/** Geometry produced by a mesh job */
+struct FVoxelMeshJobResult
+{
+	/** One set of mesh buffers per entry of FVoxelMeshJob::Sections */
+	TArray<FVoxelMeshBuffers> SectionBuffers;
+
+	/** Per entry of FVoxelMeshJob::Sections, the mesh cache's copy to upload instead of SectionBuffers, if any */
+	TArray<FVoxelMeshCache::FSharedBuffers> CachedSections;
+
+	/** Simple collision boxes in chunk space, empty unless the job rebuilt collision */
+	TArray<FBox> CollisionBoxes;
+
+	/** Face connectivity of the snapshot, only computed when opaque sections were rebuilt */
+	uint16 FaceConnectivity = VoxelCoordinates::AllFacePairs;
+};
+
+/** Chunk mesh sections being built on a worker thread from a snapshot of the chunk */
+struct FVoxelMeshJob
+{
+	/** Chunk the mesh is for */
+	TWeakObjectPtr<AVoxelChunk> Chunk;
+
+	/** Sections being built */
+	TArray<int32> Sections;
+
+	/** Revision of each section when the snapshot was taken */
+	TArray<uint32> SectionRevisions;
+
+	/** The job also rebuilds the chunk's simple collision */
+	bool bBuildCollision = false;
+
+	/** Collision revision when the snapshot was taken */
+	uint32 CollisionRevision = 0;
+
+	/** The job also recomputes the chunk's face connectivity */
+	bool bComputeConnectivity = false;
+
+	/** Connectivity revision when the snapshot was taken */
+	uint32 ConnectivityRevision = 0;
+
+	/** Worker task producing the geometry */
+	UE::Tasks::TTask<FVoxelMeshJobResult> Task;
+};
+
 /**
  * Manages the voxel world, including chunk generation and world generation
  * Supports modding through data-driven world generation parameters
@@ -35,10 +117,178 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "World Generation")
 	float NoiseFrequency = 0.01f;
 
-	/** Generate or load chunk at world position */
+	/** Maximum number of unloaded chunk actors kept for reuse; extras are destroyed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (ClampMin = "0"))
+	int32 MaxChunkPoolSize = 128;
+
+	/** Number of chunk actors spawned into the pool on BeginPlay */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (ClampMin = "0"))
+	int32 ChunkPoolPrewarmCount = 32;
+
+	/** Time per frame spent rebuilding queued chunk meshes, in milliseconds (at least one rebuild always runs) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Meshing", meta = (ClampMin = "0.0"))
+	float RemeshBudgetMs = 2.0f;
+
+	/** Maximum number of chunk meshes built on worker threads at once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Meshing", meta = (ClampMin = "1"))
+	int32 MaxMeshJobsInFlight = 8;
+
+	/** Mesher used for chunk geometry; greedy merges coplanar faces into far fewer quads */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Meshing")
+	EVoxelMeshingMode MeshingMode = EVoxelMeshingMode::Greedy;
+
+	/** Mesh sections kept in the content-hash mesh cache for identical chunks to share; 0 disables the cache. Read on BeginPlay */
+	UPROPERTY(EditAnywhere, Category = "Meshing", meta = (ClampMin = "0"))
+	int32 MaxMeshCacheEntries = 512;
+
+	/**
+	 * Chunk distances from the player where each coarser level of detail starts
+	 * Chunks farther than entry i are meshed from cells of 2^(i+1) voxels per axis, up to 8x.
+	 * Borders between different levels are closed with skirt walls. Empty keeps every chunk at full resolution.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level of Detail")
+	TArray<float> LodRingDistances = { 3.0f, 5.0f, 7.0f };
+
+	/** Hide chunks the camera cannot see into through connected air and water, e.g. underground */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visibility")
+	bool bEnableCaveCulling = true;
+
+	/** Merge the opaque meshes of settled chunks into one render batch per region, cutting primitives and draw calls */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Render Batching")
+	bool bEnableRenderBatching = true;
+
+	/** Edge length of a render region in chunks; each region batches a RenderRegionSize x RenderRegionSize column of one chunk layer */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Render Batching", meta = (ClampMin = "1"))
+	int32 RenderRegionSize = 4;
+
+	/** Seconds a chunk's opaque mesh must stay unchanged before it joins its region; edited chunks leave at once */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Render Batching", meta = (ClampMin = "0.0"))
+	float RenderBatchSettleTime = 5.0f;
+
+	/** Regions merged per frame for newly settled chunks; regions a chunk left always re-merge in the same frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Render Batching", meta = (ClampMin = "1"))
+	int32 MaxRenderRegionMergesPerFrame = 2;
+
+	/** Seconds per water step; every chunk with moving water is stepped once per interval, in phases spread over the frames in between */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water", meta = (ClampMin = "0.01"))
+	float WaterStepInterval = 0.1f;
+
+	/** Chunks closer than this to a pawn or simulating physics body get simple collision, in world units */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision", meta = (ClampMin = "0.0"))
+	float CollisionRadius = 4000.0f;
+
+	/** Seconds between scans for actors that need chunk collision */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision", meta = (ClampMin = "0.0"))
+	float CollisionUpdateInterval = 0.25f;
+
+	/** Generate or load chunk at world position, spawning its actor if it has none yet */
 	UFUNCTION(BlueprintCallable, Category = "Voxel World")
 	AVoxelChunk* GetOrCreateChunk(FIntVector ChunkCoordinate);
 
+	/** Queue a dirty chunk for a mesh rebuild; called by AVoxelChunk::MarkMeshDirty */
+	void RequestChunkRemesh(AVoxelChunk* Chunk);
+
+	/**
+	 * Fill the halo of a chunk's mesh input from its loaded neighbours at the input's level of detail
+	 * Unloaded neighbours and neighbours at another level stay air, so the chunk keeps its border
+	 * faces as a skirt that hides cracks against the differently sampled neighbour.
+	 */
+	void CopyNeighborHalo(FIntVector ChunkCoordinate, FVoxelMeshInput& Input) const;
+
+	/**
+	 * Remesh the neighbours whose halo overlaps changed border voxels
+	 * @param FaceMask Bit i selects the neighbour at VoxelCoordinates::FaceDirections[i]
+	 * @param SectionMask Sections holding the changed voxels; the four horizontal neighbours rebuild the same
+	 *                    sections, vertical neighbours only their facing slab and the water section
+	 */
+	void MarkNeighborMeshesDirty(FIntVector ChunkCoordinate, uint8 FaceMask, uint32 SectionMask = AVoxelChunk::AllMeshSections, bool bPlayerEdit = false);
+
+	/**
+	 * Read the type and water level of a voxel in any loaded chunk, for water flowing across chunk borders
+	 * @return False if the voxel's chunk is not loaded
+	 */
+	bool GetWaterCell(FIntVector VoxelCoordinate, EVoxelType& OutType, uint8& OutWaterLevel) const;
+
+	/** Voxels of a loaded chunk, actor or not, for water steps that read whole neighbour layers; null if the chunk is not loaded */
+	const FVoxelChunkStorage* FindChunkVoxels(FIntVector ChunkCoordinate) const;
+
+	/**
+	 * Merge and write the proposals of a water step, see AVoxelChunk::MergeWaterWrites
+	 * Actorless target chunks get an actor; every changed chunk remeshes its water once and wakes the
+	 * cells around each write. Targets in chunks that are not loaded are dropped.
+	 */
+	void ApplyWaterWrites(TArray<FVoxelWaterWrite>& Writes);
+
+	/** Queue a voxel for the next water step of its chunk, if the chunk has an actor */
+	void ActivateWaterAt(FIntVector VoxelCoordinate);
+
+	/** Schedule a chunk whose water was asleep for the next water step; called by AVoxelChunk when it queues its first cell */
+	void WakeChunkWater(FIntVector ChunkCoordinate) { AwakeWaterChunks.Add(ChunkCoordinate); }
+
+	/** Number of chunks stepped by the current water step */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Water")
+	int32 GetNumWaterStepChunks() const { return WaterStepQueue.Num(); }
+
+	/** Number of chunks whose water is awake; settled chunks sleep until an edit, flow or new neighbour touches them */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Water")
+	int32 GetNumAwakeWaterChunks() const { return AwakeWaterChunks.Num(); }
+
+	/** Number of voxels queued for the next step across all awake chunks */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Water")
+	int32 GetNumActiveWaterCells() const;
+
+	/** Number of chunks waiting for a mesh rebuild */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World")
+	int32 GetRemeshQueueLength() const { return RemeshQueue.Num(); }
+
+	/** Number of chunk meshes currently being built on worker threads */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World")
+	int32 GetNumMeshJobsInFlight() const { return MeshJobs.Num(); }
+
+	/** Number of chunk actors that currently keep simple collision */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World")
+	int32 GetNumCollisionChunks() const;
+
+	/** Section builds answered by the mesh cache since the last reset */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Mesh Cache")
+	int64 GetMeshCacheHits() const { return MeshCache.IsValid() ? MeshCache->GetNumHits() : 0; }
+
+	/** Section builds that missed the mesh cache and were meshed since the last reset */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Mesh Cache")
+	int64 GetMeshCacheMisses() const { return MeshCache.IsValid() ? MeshCache->GetNumMisses() : 0; }
+
+	/** Fraction of section builds answered by the mesh cache since the last reset */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Mesh Cache")
+	float GetMeshCacheHitRate() const;
+
+	/** Number of mesh sections currently cached */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Mesh Cache")
+	int32 GetNumMeshCacheEntries() const { return MeshCache.IsValid() ? MeshCache->Num() : 0; }
+
+	/** Zero the mesh cache hit and miss counters, e.g. before measuring a scene */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Mesh Cache")
+	void ResetMeshCacheStats();
+
+	/** Number of chunk actors hidden by cave culling in the last frame */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World")
+	int32 GetNumCaveCulledChunks() const { return NumCaveCulledChunks; }
+
+	/** Number of render regions currently batching chunks */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Render Batching")
+	int32 GetNumRenderRegions() const { return RenderRegions.Num(); }
+
+	/** Number of chunk actors whose opaque meshes are drawn by a render region */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Render Batching")
+	int32 GetNumRenderBatchedChunks() const;
+
+	/** Number of loaded chunks, including actorless ones */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World")
+	int32 GetNumLoadedChunks() const { return LoadedChunks.Num(); }
+
+	/** Number of loaded chunks that have a spawned actor */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World")
+	int32 GetNumChunkActors() const;
+
 	/** Update visible chunks around player */
 	UFUNCTION(BlueprintCallable, Category = "Voxel World")
 	void UpdateVisibleChunks(FVector PlayerPosition);
@@ -51,6 +301,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel World")
 	void SetVoxelAtWorldPosition(FVector WorldPosition, EVoxelType Type);
 
+	/**
+	 * Apply a list of voxel edits, grouping writes by chunk and remeshing each changed chunk once
+	 * @return Coordinates of the chunks whose voxels changed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Editing")
+	TArray<FIntVector> ApplyVoxelEdits(const TArray<FVoxelEdit>& Edits);
+
+	/** Fill every voxel overlapping the box between two world-space corners; the larger corner is exclusive */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Editing")
+	TArray<FIntVector> SetVoxelsInBox(FVector MinCorner, FVector MaxCorner, EVoxelType Type);
+
+	/** Fill every voxel whose center lies inside the sphere */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Editing")
+	TArray<FIntVector> SetVoxelsInSphere(FVector Center, float Radius, EVoxelType Type);
+
+	/** Fill every voxel a line segment passes through, face-connected from the start voxel to the end voxel */
+	UFUNCTION(BlueprintCallable, Category = "Voxel World|Editing")
+	TArray<FIntVector> SetVoxelsAlongLine(FVector Start, FVector End, EVoxelType Type);
+
 	/** Save world data for persistence/modding */
 	UFUNCTION(BlueprintCallable, Category = "Voxel World")
 	void SaveWorldData(const FString& SaveName);
@@ -61,14 +330,172 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 
-	/** Map of loaded chunks */
+	/** Map of loaded chunks, with or without an actor */
+	UPROPERTY()
+	TMap<FIntVector, FVoxelChunkEntry> LoadedChunks;
+
+	/** Parked chunk actors waiting to be reused */
 	UPROPERTY()
-	TMap<FIntVector, AVoxelChunk*> LoadedChunks;
+	TArray<AVoxelChunk*> ChunkPool;
+
+	/** Dirty chunks waiting for a mesh rebuild, in request order */
+	TArray<TWeakObjectPtr<AVoxelChunk>> RemeshQueue;
+
+	/** Chunks in RemeshQueue, so a chunk re-dirtied or reused from the pool before its rebuild starts is queued once */
+	TSet<TWeakObjectPtr<AVoxelChunk>> QueuedRemeshChunks;
+
+	/** Mesh jobs running on worker threads or waiting for their upload */
+	TArray<FVoxelMeshJob> MeshJobs;
+
+	/** Sections shared between chunks with identical mesh inputs, null while disabled; shared with running jobs */
+	TSharedPtr<FVoxelMeshCache, ESPMode::ThreadSafe> MeshCache;
+
+	/** Uploaded job buffers kept with their allocations for the next jobs */
+	TArray<FVoxelMeshBuffers> SpareMeshBuffers;
+
+	/** Return a finished job's section buffers to SpareMeshBuffers */
+	void RecycleMeshBuffers(FVoxelMeshJobResult& Result);
+
+	/**
+	 * Upload finished meshes within the frame budget, then start jobs for queued chunks,
+	 * player edits first then nearest to a player, until MaxMeshJobsInFlight are running
+	 */
+	void ProcessRemeshQueue();
+
+	/** Upload finished mesh jobs until the deadline passes, dropping results superseded by newer edits */
+	void CompleteMeshJobs(double Deadline);
+
+	/**
+	 * Phases of a water step, one per chunk coordinate parity. Chunks of one phase never share a face,
+	 * so no chunk steps in the same phase as a neighbour it reads or writes.
+	 */
+	static constexpr int32 NumWaterStepPhases = 8;
+
+	/** Chunks that queued water cells since their last step; everything else sleeps and costs nothing */
+	TSet<FIntVector> AwakeWaterChunks;
+
+	/** Chunks with queued water cells at the start of the current water step, by phase then coordinate */
+	TArray<TWeakObjectPtr<AVoxelChunk>> WaterStepQueue;
+
+	/** End of each phase's chunks in WaterStepQueue */
+	int32 WaterPhaseEnds[NumWaterStepPhases] = {};
+
+	/** Next phase of the current water step to run */
+	int32 WaterStepPhase = NumWaterStepPhases;
+
+	/** Time since the current water step started */
+	float WaterStepElapsed = 0.0f;
+
+	/** Proposed writes of each chunk in the running phase, kept for their allocations */
+	TArray<TArray<FVoxelWaterWrite>> WaterWriteBuffers;
+
+	/** All proposed writes of the running phase */
+	TArray<FVoxelWaterWrite> WaterWrites;
 
-	/** Generate terrain for a chunk */
-	void GenerateChunkTerrain(AVoxelChunk* Chunk);
+	/**
+	 * Advance the fixed-step water simulation, running the phases due by now so water-heavy areas
+	 * cost a little every frame instead of everything at once. The outcome depends only on the
+	 * phase order, never on frame timing or on which thread stepped a chunk.
+	 */
+	void UpdateWater(float DeltaTime);
+
+	/** Queue the awake chunks for a new water step and put chunks without queued cells to sleep */
+	void BeginWaterStep();
+
+	/** Draw the bounds and active cell counts of chunks with awake water, for voxel.ShowAwakeWater */
+	void DrawAwakeWaterDebug() const;
+
+	/** Compute one phase's chunks in parallel from the voxels as they are, then merge and apply their writes */
+	void RunWaterStepPhase(int32 Phase);
+
+	/** Chunks reached by the last cave culling pass */
+	TSet<FIntVector> CaveVisibleChunks;
+
+	/** Chunk actors hidden by the last cave culling pass */
+	int32 NumCaveCulledChunks = 0;
+
+	/**
+	 * Walk the chunk graph from the camera chunk, stepping from one chunk into the next only through
+	 * faces its transparent voxels connect and never back towards the camera, then hide every chunk
+	 * actor that was not reached
+	 */
+	void UpdateCaveCulling();
+
+	/** Face connectivity of a loaded chunk; actorless chunks are all air or all solid */
+	uint16 GetEntryFaceConnectivity(const FVoxelChunkEntry& Entry) const;
+
+	/** Render regions by region coordinate */
+	UPROPERTY()
+	TMap<FIntVector, AVoxelRenderRegion*> RenderRegions;
+
+	/**
+	 * Add settled chunks to their render regions, re-merge regions whose members changed and
+	 * destroy empty ones; dissolves every region while batching is disabled
+	 */
+	void UpdateRenderRegions();
+
+	/** Region a chunk is batched into */
+	FIntVector GetRenderRegionCoordinate(FIntVector ChunkCoordinate) const;
+
+	/** Spawn the actor for a render region, placed at its first chunk */
+	AVoxelRenderRegion* SpawnRenderRegion(FIntVector RegionCoordinate);
+
+	/** Chunk the level of detail rings are centred on */
+	FIntVector LodCenterChunk = FIntVector::ZeroValue;
+
+	/** Level of detail a chunk is meshed at with the rings centred on CenterChunk */
+	int32 GetChunkLodLevel(FIntVector ChunkCoordinate, FIntVector CenterChunk) const;
+
+	/** Locations of pawns and simulating physics bodies from the last collision scan */
+	TArray<FVector> CollisionSources;
+
+	/** Every actor but the world's own chunks and regions; scanned for pawns and simulating bodies */
+	TArray<TWeakObjectPtr<AActor>> CollisionCandidates;
+
+	/** Registration of OnActorSpawned, which adds new candidates */
+	FDelegateHandle ActorSpawnedHandle;
+
+	/** Track an actor as a collision candidate unless it belongs to the voxel world */
+	void TrackCollisionCandidate(AActor* Actor);
+
+	/** Time until the next collision scan */
+	float CollisionUpdateTimer = 0.0f;
+
+	/** Refresh CollisionSources and enable collision only on chunks within CollisionRadius of one */
+	void UpdateChunkCollision();
+
+	/** Whether a chunk lies within CollisionRadius of any collision source */
+	bool IsChunkInCollisionRange(FIntVector ChunkCoordinate) const;
+
+	/** Take a chunk actor from the pool, spawning one if the pool is empty */
+	AVoxelChunk* AcquireChunkActor();
+
+	/** Reset and park a chunk actor, or destroy it if the pool is full */
+	void ReleaseChunkActor(AVoxelChunk* Chunk);
+
+	/** Generate terrain for a chunk into its voxel planes */
+	void GenerateChunkTerrain(FIntVector ChunkCoordinate, FVoxelChunkStorage& Voxels);
+
+	/** Generate the chunk's voxels if it is not loaded yet, spawning an actor only if it has visible geometry */
+	void EnsureChunkLoaded(FIntVector ChunkCoordinate);
+
+	/** Spawn the actor for a loaded chunk and hand it the chunk's voxels */
+	AVoxelChunk* PromoteChunk(FIntVector ChunkCoordinate);
+
+	/** Promote actorless neighbours of a chunk that have become exposed */
+	void RefreshNeighborPromotion(FIntVector ChunkCoordinate);
+
+	/** Whether a chunk's voxels produce any visible faces given its loaded neighbours */
+	bool ChunkNeedsActor(FIntVector ChunkCoordinate, const FVoxelChunkStorage& Voxels) const;
+
+	/** Whether every voxel on one face layer of a chunk is solid */
+	bool IsChunkFaceSolid(const FVoxelChunkStorage& Voxels, const FIntVector& FaceDirection) const;
+
+	/** Voxels of a loaded chunk, wherever they currently live */
+	const FVoxelChunkStorage& GetEntryVoxels(const FVoxelChunkEntry& Entry) const;
 
 	/** Perlin noise function for terrain generation */
 	float PerlinNoise(float X, float Y, float Z);
@@ -76,6 +503,12 @@ protected:
 	/** Get chunk coordinate from world position */
 	FIntVector WorldToChunkCoordinate(FVector WorldPosition) const;
 
+	/** Get global voxel coordinate from world position */
+	FIntVector WorldToVoxelCoordinate(FVector WorldPosition) const;
+
+	/** Write voxels given in global voxel coordinates, one remesh per changed chunk */
+	TArray<FIntVector> ApplyVoxelCoordinateEdits(const TArray<TPair<FIntVector, EVoxelType>>& Edits);
+
 	/** Last player position for chunk loading */
 	FVector LastPlayerPosition;
 };